@@ -1,5 +1,6 @@
 #define _USE_MATH_DEFINES
 #include <gtk/gtk.h>
+#include <limits.h>
 #include <locale.h>
 #include <math.h>
 #include <stdarg.h>
@@ -10,6 +11,11 @@
 #include <string.h>
 #include <time.h>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
+
 #ifdef _WIN32
 #include <windows.h>
 #else
@@ -18,6 +24,13 @@
 #include <unistd.h>
 #endif
 
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#define HAVE_PERF_EVENTS 1
+#endif
+
 // =============================================================================
 //                             CONSTANTES GLOBALES
 // =============================================================================
@@ -26,6 +39,9 @@
 #define CANVAS_HEIGHT 300
 #define VISUAL_NODES_PER_ROW 15
 #define NODE_DISPLAY_BATCH 50
+#define NUM_SORT_ALGOS 8 // Entries of algo_selector_combo
+#define LIST_MERGE_SORT NUM_SORT_ALGOS // Lists only: relinks the nodes
+#define BENCH_MAX_OPS 8  // Curves of the largest benchmark suite
 
 // =============================================================================
 //                             DÉFINITIONS TYPES ET ÉNUMÉRATIONS
@@ -59,18 +75,87 @@
 
 typedef enum { DATA_INT, DATA_FLOAT, DATA_CHAR, DATA_STRING } DataType;
 
+// Shape of generated inputs (see "Input distributions")
+typedef enum {
+  DIST_RANDOM,
+  DIST_SORTED,
+  DIST_REVERSED,
+  DIST_SAWTOOTH,
+  DIST_ORGAN_PIPE,
+  DIST_K_SORTED,
+  DIST_FEW_UNIQUE,
+  DIST_ZIPF,
+  DIST_ALL_EQUAL,
+  NUM_DISTS
+} Distribution;
+
 typedef enum {
   STRUCTURE_ARRAY,
   STRUCTURE_SIMPLE_LIST,
-  STRUCTURE_DOUBLE_LIST
+  STRUCTURE_DOUBLE_LIST,
+  STRUCTURE_UNROLLED_LIST, // Blocks of values (see "Unrolled lists")
+  STRUCTURE_SKIP_LIST,     // Indexed by position (see "Skip lists")
+  NUM_STRUCTURES
 } StructureType;
 
 // =============================================================================
 //                             STRUCTURES DE DONNÉES
 // =============================================================================
+// xoshiro256** state (see "Random numbers"); one per generating context
+typedef struct {
+  uint64_t s[4];
+} Rng;
+
+// Work done by one sort run (see "Operation counters")
 typedef struct {
-  double time_ns;
+  uint64_t comparisons;
+  uint64_t swaps;
+  uint64_t moves;       // Element copies outside swaps
+  uint64_t bytes_moved; // By swaps and moves
+  uint64_t allocations; // Heap blocks requested by the sort
+} SortStats;
+
+// Structures whose memory is accounted (see "Memory accounting")
+typedef enum {
+  MEM_ARRAY,
+  MEM_LIST,
+  MEM_TREE,
+  MEM_GRAPH,
+  NUM_MEM_KINDS
+} MemKind;
+
+typedef struct {
+  int64_t live_bytes;
+  int64_t live_blocks;
+  int64_t elements;     // Array slots, list/tree nodes, graph vertices
+  uint64_t allocations; // Blocks allocated so far, freed or not
+} MemStats;
+
+// CPU counters read around benchmark runs (see "Hardware counters")
+typedef enum {
+  HW_CYCLES,
+  HW_INSTRUCTIONS,
+  HW_CACHE_MISSES,
+  HW_BRANCH_MISSES,
+  HW_LLC_MISSES,
+  NUM_HW_COUNTERS
+} HwCounter;
+
+// One benchmark point; times are over the runs kept after outlier rejection
+typedef struct {
+  double time_ns;               // Median, what the curves plot
   size_t size;
+  SortStats ops;                // From the first timed run
+  uint64_t hw[NUM_HW_COUNTERS]; // Medians over the timed runs
+  unsigned hw_valid;            // Bit i set when hw[i] was measured
+  int64_t mem_bytes;            // Footprint of the input structure
+  int64_t mem_blocks;
+  int runs;                     // 0 when the point was skipped
+  double time_min;
+  double time_p95;
+  double time_stddev;
+  double time_ci_lo; // 95% confidence interval of the median
+  double time_ci_hi;
 } PerformancePoint;
 
 typedef struct {
@@ -80,36 +165,82 @@ typedef struct {
   int algo_index;
 } ComparisonCurve;
 
+// Owner of a structure's DATA_STRING elements (see "String arena")
+typedef struct StrArena StrArena;
+
 typedef struct {
   DataType type;
   size_t size;
   void *data;
   size_t element_size;
   int (*compare_func)(const void *, const void *);
+  StrArena *strings; // DATA_STRING only, may be shared with copies
 } Array;
 
+// Pool of list or tree nodes (see "Node pools")
+typedef struct NodePool NodePool;
+
+// Node values are stored inline: an int, float, char or string pointer
+#define NODE_VALUE_SIZE sizeof(void *)
+
 typedef struct Node {
-  void *data;
   struct Node *next;
   struct Node *prev;
+  _Alignas(char *) char data[NODE_VALUE_SIZE];
 } Node;
 
+// Block of an unrolled list: count values stored side by side
+#define LIST_BLOCK_BYTES 128 // Values per block: 32 ints, 16 strings
+
+typedef struct ListBlock ListBlock;
+struct ListBlock {
+  ListBlock *next;
+  ListBlock *prev;
+  size_t count;
+  _Alignas(char *) char data[];
+};
+
+// Node of a skip list: its value and height forward links
+#define SKIP_MAX_LEVEL 16 // Enough for 4^16 values
+
+typedef struct SkipNode SkipNode;
+typedef struct {
+  SkipNode *next;
+  size_t width; // Positions from this node to next (to the end when NULL)
+} SkipLink;
+
+struct SkipNode {
+  int height;
+  _Alignas(char *) char data[NODE_VALUE_SIZE];
+  SkipLink links[]; // links[0] goes to the following value
+};
+
 typedef struct {
   DataType type;
   size_t size;
-  Node *head;
+  Node *head; // Simple and double lists
   Node *tail;
   gboolean is_doubly_linked;
   int (*compare_func)(const void *, const void *);
+  StrArena *strings; // DATA_STRING only, may be shared with copies
+  NodePool *nodes;   // Its nodes, or its blocks when unrolled
+  StructureType kind;
+  ListBlock *first; // Unrolled lists
+  ListBlock *last;
+  size_t block_cap;      // Values per block
+  SkipNode *skip_head;   // Skip lists: sentinel before the first value
+  int skip_level;        // Levels in use
+  NodePool **skip_pools; // By node height, the first being nodes
+  Rng skip_rng;          // Node heights
 } LinkedList;
 
 typedef struct TreeNode TreeNode;
 struct TreeNode {
-  void *data;
   TreeNode *left;
   TreeNode *right;
   GSList *children;
   TreeNode *parent;
+  _Alignas(char *) char data[NODE_VALUE_SIZE];
 };
 
 // Structures pour l'affichage de l'arbre (Reingold-Tilford)
@@ -164,8 +295,14 @@ typedef struct {
   int node_count;
   int next_id_counter;
   gboolean is_directed;
+  StrArena *strings; // DATA_STRING only, interned
 } Graph;
 
+typedef struct SortTrace SortTrace;
+typedef struct TracePlayer TracePlayer;
+typedef struct BenchJob BenchJob;
+typedef struct Baseline Baseline;
+
 // Main App Data
 typedef struct {
   GtkWidget *window;
@@ -192,6 +329,7 @@ typedef struct {
 
   // Array Input
   GtkWidget *array_mode_combo; // Random / Manuel
+  GtkWidget *array_dist_combo; // Distribution of random inputs
   GtkWidget *array_manual_entry;
   GtkWidget *array_size_entry;
   GtkWidget *array_canvas_before; // TextView
@@ -201,9 +339,11 @@ typedef struct {
 
   // List Input
   GtkWidget *list_mode_combo;
+  GtkWidget *list_dist_combo;
   GtkWidget *list_manual_entry;
   GtkWidget *list_size_entry;
-  GtkWidget *list_type_combo; // Simple/Double
+  GtkWidget *list_type_combo; // Simple/Double/Unrolled/Skip
+  GtkWidget *btn_list_merge;  // Greyed out unless current_list relinks
   GtkWidget *list_canvas;
   GtkWidget *list_val_entry;
   GtkWidget *list_loc_combo; // Debut/Fin/Pos
@@ -241,6 +381,7 @@ typedef struct {
 
   // Tree Data
   gpointer tree_root;
+  NodePool *tree_nodes; // Owns the tree's nodes, created with the first one
   DataType tree_data_type;
   gboolean tree_is_nary;
   int tree_nary_degree;
@@ -268,16 +409,28 @@ typedef struct {
   // Comparison
   GtkWidget *compare_window;
   GtkWidget *comparison_canvas;
-  ComparisonCurve *comparison_data[8];
+  ComparisonCurve *comparison_data[BENCH_MAX_OPS];
   int num_curves;
   int num_sizes;
   size_t *test_sizes;
   GtkWidget *comparison_progress;
+  GtkWidget *comparison_cancel;
+  BenchJob *bench_job; // Running benchmark, NULL when idle
+  GtkWidget *comparison_suite_combo;
+  int comparison_suite;        // BenchSuite of the curves
+  gboolean comparison_restart; // Run again once the cancelled job ends
+  int compare_metric;  // CompareMetric plotted on the y axis
+  int comparison_dist; // Distribution of the benchmark inputs
+  DataType comparison_type;
+  StructureType comparison_structure;
+  int comparison_threads; // Parallel Sort workers of the last benchmark
+  Baseline *baseline;     // Reference the curves are checked against
   gboolean is_dark_theme;
   gboolean is_benchmarking;
 
   // Global Settings
   double animation_speed; // 0.0 to 1.0 (0=Instant, 1=Very Slow)
+  int sort_threads;       // Parallel Sort workers (0=one per core)
   DataType default_data_type;
 
   // Pseudo-code Panel
@@ -289,7 +442,9 @@ typedef struct {
   // Animation Window
   GtkWidget *anim_win;
   GtkWidget *anim_canvas;
-  Array *demo_array;
+  TracePlayer *player; // Replays the trace shown in the window
+
+  Rng rng; // Everything the UI generates draws from here
 
   // Session Stats
   int total_ops;
@@ -310,14 +465,17 @@ typedef struct {
 // =============================================================================
 //                             PROTOTYPES DES FONCTIONS
 // =============================================================================
-static void open_animation_window(AppData *app);
+static void open_animation_window(AppData *app, SortTrace *trace);
 static void on_anim_window_destroy(GtkWidget *widget, gpointer user_data);
 uint64_t get_nanoseconds();
 size_t get_element_size(DataType type);
 int (*get_compare_func(DataType type))(const void *, const void *);
+static int str_compare(const char *a, const char *b);
 void set_status(AppData *app_data, const char *format, ...);
 void update_dashboard_stats(AppData *app, int structure_idx, size_t count,
                             double time_ms);
+void update_dashboard_sort_ops(AppData *app, int structure_idx,
+                               const SortStats *ops);
 void show_mode_popup(GtkWidget *widget, gpointer user_data);
 void set_buffer_markup(GtkTextBuffer *buffer, const char *markup);
 
@@ -329,26 +487,33 @@ void on_tree_transform(GtkWidget *widget, gpointer user_data);
 Array *create_array(DataType type, size_t size);
 void free_array(Array *array);
 Array *copy_array(const Array *original);
-void fill_array_random(Array *array);
+void fill_array_random(Array *array, Rng *rng);
+void fill_array_dist(Array *array, Distribution dist, Rng *rng);
 char *array_to_string(const Array *array, gboolean styled, AppData *app);
-uint64_t sort_array_wrapper(AppData *app, Array *array, int algo_index);
+uint64_t sort_array_wrapper(AppData *app, Array *array, int algo_index,
+                            SortStats *stats);
 
 // Lists
+LinkedList *create_list(DataType type, StructureType kind);
 LinkedList *create_linked_list(DataType type, gboolean is_doubly_linked);
 void free_linked_list(LinkedList *list);
-void fill_linked_list_random(LinkedList *list, size_t size);
+void fill_linked_list_random(LinkedList *list, size_t size, Rng *rng);
+void fill_linked_list_dist(LinkedList *list, size_t size, Distribution dist,
+                           Rng *rng);
 void insert_to_linkedlist(LinkedList *list, Node *new_node, int position);
 gboolean delete_from_linkedlist(LinkedList *list, int position);
 gboolean modify_linkedlist(LinkedList *list, int position,
                            const char *value_str);
 char *list_to_string(const LinkedList *list, gboolean styled);
-Node *create_node(DataType type, const void *value);
-uint64_t sort_list_wrapper(AppData *app, LinkedList *list, int algo_index);
+Node *create_node(LinkedList *list, const void *value);
+void list_insert_value(LinkedList *list, const void *value, int position);
+uint64_t sort_list_wrapper(AppData *app, LinkedList *list, int algo_index,
+                           SortStats *stats);
 LinkedList *copy_linked_list(const LinkedList *src);
 
 // Trees
-TreeNode *create_tree_node(DataType type, const void *value);
-void free_tree(TreeNode *root, DataType type);
+TreeNode *create_tree_node(NodePool *pool, DataType type, const void *value);
+void free_tree(NodePool *pool, TreeNode *root, DataType type);
 void insert_tree_random(AppData *app_data, size_t count);
 gboolean insert_tree_manual(AppData *app_data, const char *value_str);
 gboolean modify_tree_node(AppData *app_data, const char *old_str,
@@ -377,6 +542,7 @@ void on_generate_tree(GtkWidget *widget, gpointer user_data);
 void on_tree_action(GtkWidget *widget, gpointer user_data); // Traversal changes
 void on_graph_action(GtkWidget *widget, gpointer user_data); // Graph buttons
 void on_compare_launch(GtkWidget *widget, gpointer user_data);
+void run_comparison_benchmark(AppData *app);
 
 // Drawing
 gboolean on_draw_list(GtkWidget *widget, cairo_t *cr, gpointer user_data);
@@ -388,6 +554,7 @@ gboolean on_draw_compare(GtkWidget *widget, cairo_t *cr, gpointer user_data);
 void apply_css(GtkWidget *widget, AppData *app);
 void on_toggle_theme(GtkWidget *widget, gpointer user_data);
 void on_speed_changed(GtkRange *range, gpointer user_data);
+void on_threads_changed(GtkSpinButton *spin, gpointer user_data);
 void on_reset_session(GtkWidget *widget, gpointer user_data);
 void draw_arrow(cairo_t *cr, double x1, double y1, double x2, double y2);
 
@@ -445,7 +612,7 @@ static int compare_strings(const void *a, const void *b) {
     return -1;
   if (!sb)
     return 1;
-  return strcmp(sa, sb);
+  return str_compare(sa, sb);
 }
 
 int (*get_compare_func(DataType type))(const void *, const void *) {
@@ -478,6 +645,567 @@ void set_status(AppData *app_data, const char *format, ...) {
     gtk_main_iteration();
 }
 
+// --- Profiling spans ---
+// PROF_SCOPE("name") times the rest of the enclosing block and records it as
+// a complete event in the calling thread's ring. Each ring has one writer,
+// so recording is a clock read and a store; the ring's head is published
+// atomically and a dump copies what it sees, dropping any slot the owner
+// overwrote meanwhile. Rings are pooled: a thread claims one on its first
+// span and gives it back when it exits, so the pool workers started for
+// every parallel sort do not grow memory. Events outlive their thread and
+// carry its id and name. prof_write_chrome_trace() writes everything still
+// held in the rings as Chrome trace JSON (chrome://tracing, Perfetto).
+#define PROF_RING_EVENTS 4096 // Per thread, power of two
+
+typedef struct {
+  const char *name; // Static string
+  const char *thread;
+  uint64_t start_ns;
+  uint64_t dur_ns;
+  guint tid;
+} ProfEvent;
+
+typedef struct ProfRing {
+  ProfEvent events[PROF_RING_EVENTS];
+  guint head; // Events recorded so far, only the owner advances it
+  gint claimed;
+  struct ProfRing *next; // Pool list, only ever pushed to
+} ProfRing;
+
+typedef struct {
+  const char *name;
+  uint64_t start_ns;
+} ProfSpan;
+
+typedef struct {
+  ProfRing *ring;
+  const char *name;
+  guint tid;
+} ProfThread;
+
+static ProfRing *prof_rings;
+static guint prof_next_tid;
+static uint64_t prof_epoch_ns;
+static _Thread_local ProfThread prof_thread;
+
+static void prof_release_ring(gpointer ring) {
+  g_atomic_int_set(&((ProfRing *)ring)->claimed, 0);
+}
+
+static GPrivate prof_ring_key = G_PRIVATE_INIT(prof_release_ring);
+
+static ProfRing *prof_claim_ring(void) {
+  ProfRing *ring = g_atomic_pointer_get(&prof_rings);
+  for (; ring; ring = ring->next)
+    if (g_atomic_int_compare_and_exchange(&ring->claimed, 0, 1))
+      break;
+  if (!ring) {
+    ring = g_new0(ProfRing, 1);
+    ring->claimed = 1;
+    do
+      ring->next = g_atomic_pointer_get(&prof_rings);
+    while (!g_atomic_pointer_compare_and_exchange(&prof_rings, ring->next,
+                                                  ring));
+  }
+  if (!prof_thread.tid)
+    prof_thread.tid = (guint)g_atomic_int_add(&prof_next_tid, 1) + 1;
+  g_private_set(&prof_ring_key, ring);
+  return ring;
+}
+
+// Names the calling thread in dumps; call before its first span.
+static void prof_thread_name(const char *name) { prof_thread.name = name; }
+
+static ProfSpan prof_begin(const char *name) {
+  return (ProfSpan){name, get_nanoseconds()};
+}
+
+static void prof_end(ProfSpan span) {
+  uint64_t end = get_nanoseconds();
+  ProfRing *ring = prof_thread.ring;
+  if (!ring)
+    ring = prof_thread.ring = prof_claim_ring();
+  guint head = ring->head;
+  ProfEvent *e = &ring->events[head & (PROF_RING_EVENTS - 1)];
+  e->name = span.name;
+  e->thread = prof_thread.name;
+  e->start_ns = span.start_ns;
+  e->dur_ns = end - span.start_ns;
+  e->tid = prof_thread.tid;
+  g_atomic_int_set(&ring->head, head + 1);
+}
+
+static void prof_end_scope(ProfSpan *span) { prof_end(*span); }
+
+#ifdef __GNUC__
+#define PROF_CONCAT_(a, b) a##b
+#define PROF_CONCAT(a, b) PROF_CONCAT_(a, b)
+#define PROF_SCOPE(name)                                                       \
+  ProfSpan PROF_CONCAT(prof_span_, __LINE__)                                   \
+      __attribute__((cleanup(prof_end_scope), unused)) = prof_begin(name)
+#else
+#define PROF_SCOPE(name) ((void)0)
+#endif
+
+static void prof_init(void) {
+  prof_epoch_ns = get_nanoseconds();
+  prof_thread_name("main");
+}
+
+static int prof_compare_events(const void *a, const void *b) {
+  const ProfEvent *x = a, *y = b;
+  return (x->start_ns > y->start_ns) - (x->start_ns < y->start_ns);
+}
+
+// Returns the number of events written.
+static size_t prof_write_chrome_trace(FILE *f) {
+  size_t num_rings = 0;
+  for (ProfRing *ring = g_atomic_pointer_get(&prof_rings); ring;
+       ring = ring->next)
+    num_rings++;
+  ProfEvent *events = g_new(ProfEvent, num_rings * PROF_RING_EVENTS + 1);
+  size_t count = 0;
+  for (ProfRing *ring = g_atomic_pointer_get(&prof_rings); ring;
+       ring = ring->next) {
+    guint end = (guint)g_atomic_int_get(&ring->head);
+    guint begin = end > PROF_RING_EVENTS ? end - PROF_RING_EVENTS : 0;
+    for (guint i = begin; i != end; i++)
+      events[count + (i - begin)] = ring->events[i & (PROF_RING_EVENTS - 1)];
+    // Drop slots the owner reused while we copied, counting the one it may
+    // be writing right now.
+    guint next = (guint)g_atomic_int_get(&ring->head) + 1;
+    guint stale = next - begin > PROF_RING_EVENTS
+                      ? next - begin - PROF_RING_EVENTS
+                      : 0;
+    if (stale > end - begin)
+      stale = end - begin;
+    memmove(events + count, events + count + stale,
+            (end - begin - stale) * sizeof(ProfEvent));
+    count += end - begin - stale;
+  }
+  qsort(events, count, sizeof(ProfEvent), prof_compare_events);
+
+  fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+  fprintf(f, "{\"ph\":\"M\",\"pid\":1,\"tid\":0,\"name\":\"process_name\","
+             "\"args\":{\"name\":\"DataStructureProject\"}}");
+  guint num_tids = (guint)g_atomic_int_get(&prof_next_tid) + 1;
+  gboolean *named = g_new0(gboolean, num_tids);
+  for (size_t i = 0; i < count; i++) {
+    ProfEvent *e = &events[i];
+    if (e->tid >= num_tids || named[e->tid])
+      continue;
+    named[e->tid] = TRUE;
+    fprintf(f,
+            ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\","
+            "\"args\":{\"name\":\"%s\"}}",
+            e->tid, e->thread ? e->thread : "thread");
+  }
+  g_free(named);
+  for (size_t i = 0; i < count; i++) {
+    ProfEvent *e = &events[i];
+    uint64_t start = e->start_ns > prof_epoch_ns ? e->start_ns - prof_epoch_ns
+                                                 : 0;
+    fprintf(f,
+            ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"name\":\"%s\","
+            "\"ts\":%.3f,\"dur\":%.3f}",
+            e->tid, e->name, start / 1000.0, e->dur_ns / 1000.0);
+  }
+  fprintf(f, "\n]}\n");
+  g_free(events);
+  return count;
+}
+
+// --- Operation counters ---
+// Sorts count their comparisons, swaps, element moves, bytes moved and heap
+// allocations in thread-local counters that sort_array_wrapper hands back
+// with the time. Pool workers fold theirs into the pool after each task.
+// Counting costs a thread-local update in every comparison, so it is only
+// compiled in on request (-DSORT_STATS): timings come from plain builds.
+#ifdef SORT_STATS
+static _Thread_local SortStats sort_stats_tls;
+#define STAT_COMPARE() (sort_stats_tls.comparisons++)
+#define STAT_COMPARES(k) (sort_stats_tls.comparisons += (k))
+#define STAT_SWAP(es)                                                          \
+  (sort_stats_tls.swaps++, sort_stats_tls.bytes_moved += 2 * (es))
+#define STAT_MOVE(k, es)                                                       \
+  (sort_stats_tls.moves += (k),                                                \
+   sort_stats_tls.bytes_moved += (uint64_t)(k) * (es))
+#define STAT_ALLOC(k) (sort_stats_tls.allocations += (k))
+#else
+#define STAT_COMPARE() ((void)0)
+#define STAT_COMPARES(k) ((void)0)
+#define STAT_SWAP(es) ((void)0)
+#define STAT_MOVE(k, es) ((void)0)
+#define STAT_ALLOC(k) ((void)0)
+#endif
+
+static void sort_stats_add(SortStats *dst, const SortStats *src) {
+  dst->comparisons += src->comparisons;
+  dst->swaps += src->swaps;
+  dst->moves += src->moves;
+  dst->bytes_moved += src->bytes_moved;
+  dst->allocations += src->allocations;
+}
+
+// --- Memory accounting ---
+// Structures allocate their headers, nodes, value cells, strings and GSList
+// cells through the mem_* hooks below, which keep per-structure counts of
+// live bytes, live blocks, elements and allocations made. Like the sort
+// counters they are thread-local: the dashboard reads the main thread's, a
+// benchmark worker measures its own inputs. Bytes are the sizes requested;
+// allocator headers and rounding come on top.
+static _Thread_local MemStats mem_stats_tls[NUM_MEM_KINDS];
+
+static void mem_account(MemKind kind, int64_t bytes, int64_t blocks) {
+  MemStats *m = &mem_stats_tls[kind];
+  m->live_bytes += bytes;
+  m->live_blocks += blocks;
+  if (blocks > 0)
+    m->allocations += blocks;
+}
+
+static void mem_count_elements(MemKind kind, int64_t n) {
+  mem_stats_tls[kind].elements += n;
+}
+
+static void *mem_alloc(MemKind kind, size_t bytes) {
+  if (bytes == 0)
+    return NULL;
+  mem_account(kind, (int64_t)bytes, 1);
+  return g_malloc(bytes);
+}
+
+static void *mem_alloc0(MemKind kind, size_t bytes) {
+  if (bytes == 0)
+    return NULL;
+  mem_account(kind, (int64_t)bytes, 1);
+  return g_malloc0(bytes);
+}
+
+static void mem_free(MemKind kind, void *p, size_t bytes) {
+  if (!p)
+    return;
+  mem_account(kind, -(int64_t)bytes, -1);
+  g_free(p);
+}
+
+// --- String arena ---
+// A DATA_STRING element points at bytes preceded by a StrHeader holding the
+// length and the first four bytes, so most comparisons settle on one integer
+// compare. Arrays, lists and graphs bump-allocate their strings in an arena
+// they own: copies share it by reference instead of duplicating every
+// string, a deleted element leaves its bytes until the last owner goes, and
+// the chunks are then freed together. An interning arena stores each
+// distinct string once. Tree nodes have no owning structure and use
+// standalone blocks carrying the same header. Appends are not locked: an
+// arena is only extended by the thread that works on its structures.
+typedef struct {
+  uint32_t prefix; // First 4 bytes big-endian, NUL padded: orders like strcmp
+  uint32_t len;    // Bytes before the NUL, | STR_STANDALONE for own blocks
+} StrHeader;
+
+#define STR_STANDALONE 0x80000000u
+#define STR_HEADER(s) ((const StrHeader *)(const void *)(s) - 1)
+#define STR_CHUNK_MIN 4096
+#define STR_CHUNK_MAX (1 << 20)
+
+typedef struct StrChunk StrChunk;
+struct StrChunk {
+  StrChunk *next;
+  size_t size; // Capacity of data
+  char data[];
+};
+
+struct StrArena {
+  MemKind kind;
+  gint refs;
+  StrChunk *chunks;     // Newest first; allocations come from its tail
+  size_t used;          // Bytes taken in chunks->data
+  GHashTable *interned; // Content -> string, NULL when not interning
+};
+
+static StrArena *str_arena_new(MemKind kind, gboolean intern) {
+  StrArena *a = mem_alloc0(kind, sizeof(StrArena));
+  a->kind = kind;
+  a->refs = 1;
+  if (intern)
+    a->interned = g_hash_table_new(g_str_hash, g_str_equal);
+  return a;
+}
+
+static StrArena *str_arena_ref(StrArena *a) {
+  if (a)
+    g_atomic_int_inc(&a->refs);
+  return a;
+}
+
+static void str_arena_free_chunks(StrArena *a) {
+  while (a->chunks) {
+    StrChunk *next = a->chunks->next;
+    mem_free(a->kind, a->chunks, sizeof(StrChunk) + a->chunks->size);
+    a->chunks = next;
+  }
+  a->used = 0;
+  if (a->interned)
+    g_hash_table_remove_all(a->interned);
+}
+
+static void str_arena_unref(StrArena *a) {
+  if (!a || !g_atomic_int_dec_and_test(&a->refs))
+    return;
+  str_arena_free_chunks(a);
+  if (a->interned)
+    g_hash_table_destroy(a->interned);
+  mem_free(a->kind, a, sizeof(StrArena));
+}
+
+// Drops every string at once when nothing else shares the arena, before a
+// structure is refilled
+static void str_arena_clear(StrArena *a) {
+  if (a && g_atomic_int_get(&a->refs) == 1)
+    str_arena_free_chunks(a);
+}
+
+static void str_arena_set_interning(StrArena *a, gboolean intern) {
+  if (!a || intern == (a->interned != NULL))
+    return;
+  if (intern) {
+    a->interned = g_hash_table_new(g_str_hash, g_str_equal);
+  } else {
+    g_hash_table_destroy(a->interned);
+    a->interned = NULL;
+  }
+}
+
+static inline uint32_t str_prefix4(const char *s, size_t len) {
+  uint32_t p = 0;
+  for (size_t i = 0; i < 4 && i < len; i++)
+    p |= (uint32_t)(unsigned char)s[i] << (24 - 8 * i);
+  return p;
+}
+
+static size_t str_len(const char *s) {
+  return STR_HEADER(s)->len & ~STR_STANDALONE;
+}
+
+// Header and bytes at block; returns the string
+static char *str_place(void *block, const char *src, size_t len,
+                       uint32_t flags) {
+  StrHeader *h = block;
+  h->prefix = str_prefix4(src, len);
+  h->len = (uint32_t)len | flags;
+  char *s = (char *)(h + 1);
+  memcpy(s, src, len);
+  s[len] = '\0';
+  return s;
+}
+
+// Copy of src, whose NUL is at src[len], owned by a (a standalone block
+// when a is NULL)
+static char *str_new_len(MemKind kind, StrArena *a, const char *src,
+                         size_t len) {
+  size_t need = sizeof(StrHeader) + len + 1;
+  if (!a)
+    return str_place(mem_alloc(kind, need), src, len, STR_STANDALONE);
+  if (a->interned) {
+    char *found = g_hash_table_lookup(a->interned, src);
+    if (found)
+      return found;
+  }
+  need = (need + _Alignof(StrHeader) - 1) & ~(_Alignof(StrHeader) - 1);
+  if (!a->chunks || a->used + need > a->chunks->size) {
+    size_t size = a->chunks ? MIN(a->chunks->size * 2, STR_CHUNK_MAX)
+                            : STR_CHUNK_MIN;
+    size = MAX(size, need);
+    StrChunk *c = mem_alloc(a->kind, sizeof(StrChunk) + size);
+    c->size = size;
+    c->next = a->chunks;
+    a->chunks = c;
+    a->used = 0;
+  }
+  char *s = str_place(a->chunks->data + a->used, src, len, 0);
+  a->used += need;
+  if (a->interned)
+    g_hash_table_insert(a->interned, s, s);
+  return s;
+}
+
+static char *str_new(MemKind kind, StrArena *a, const char *src) {
+  return src ? str_new_len(kind, a, src, strlen(src)) : NULL;
+}
+
+// Frees a standalone string; arena strings go with their arena
+static void str_release(MemKind kind, char *s) {
+  if (s && (STR_HEADER(s)->len & STR_STANDALONE))
+    mem_free(kind, (StrHeader *)s - 1, sizeof(StrHeader) + str_len(s) + 1);
+}
+
+// strcmp order of two header-carrying strings
+static int str_compare(const char *a, const char *b) {
+  const StrHeader *ha = STR_HEADER(a), *hb = STR_HEADER(b);
+  if (ha->prefix != hb->prefix)
+    return ha->prefix < hb->prefix ? -1 : 1;
+  if (a == b || (ha->prefix & 0xFF) == 0) // Interned, or ended in the prefix
+    return 0;
+  size_t la = ha->len & ~STR_STANDALONE, lb = hb->len & ~STR_STANDALONE;
+  return memcmp(a + 4, b + 4, MIN(la, lb) - 3); // Up to the shorter's NUL
+}
+
+// Copies *value into cell (for DATA_STRING, the string copied into strings,
+// or standalone when strings is NULL)
+static void mem_store_value(MemKind kind, DataType type, StrArena *strings,
+                            void *cell, const void *value) {
+  if (type == DATA_STRING)
+    *(char **)cell = str_new(kind, strings, *(char *const *)value);
+  else
+    memcpy(cell, value, get_element_size(type));
+}
+
+// Heap value cell of a vertex: a copy of *value, or uninitialised when value
+// is NULL
+static void *mem_new_value(MemKind kind, DataType type, StrArena *strings,
+                           const void *value) {
+  void *cell = mem_alloc(kind, get_element_size(type));
+  if (value)
+    mem_store_value(kind, type, strings, cell, value);
+  return cell;
+}
+
+static void mem_free_value(MemKind kind, DataType type, void *cell) {
+  if (!cell)
+    return;
+  if (type == DATA_STRING)
+    str_release(kind, *(char **)cell);
+  mem_free(kind, cell, get_element_size(type));
+}
+
+// --- Node pools ---
+// List and tree nodes hold their value inline and come from a pool owned by
+// their structure: slabs of nodes carved in order, with released nodes kept
+// on a free list for the next allocations. Building a structure fills its
+// slabs front to back, so walking it follows memory, and dropping it frees a
+// handful of slabs instead of one block per node. Pools count their live
+// nodes as the structure's elements unless told otherwise (an unrolled
+// list's blocks hold many). Like string arenas they are not locked.
+#define POOL_SLAB_MIN 64
+#define POOL_SLAB_MAX 4096 // Nodes per slab, unless reserved at once
+
+typedef struct PoolSlab PoolSlab;
+struct PoolSlab {
+  PoolSlab *next;
+  size_t count; // Nodes in this slab
+  _Alignas(void *) char nodes[];
+};
+
+struct NodePool {
+  MemKind kind;
+  size_t node_size;
+  PoolSlab *slabs; // Newest first; allocations come from its tail
+  size_t used;     // Nodes taken in slabs
+  void *free_list; // Released nodes, linked through their first word
+  size_t live;
+  int weight; // Elements per live node: 0 when the owner counts them
+};
+
+static NodePool *node_pool_new(MemKind kind, size_t node_size,
+                               gboolean elements) {
+  NodePool *p = mem_alloc0(kind, sizeof(NodePool));
+  p->kind = kind;
+  p->node_size = (node_size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+  p->weight = elements ? 1 : 0;
+  return p;
+}
+
+// Starts a new slab unless the current one has n nodes left
+static void node_pool_grow(NodePool *p, size_t n) {
+  if (p->slabs && p->slabs->count - p->used >= n)
+    return;
+  size_t count = p->slabs ? MIN(p->slabs->count * 2, POOL_SLAB_MAX)
+                          : POOL_SLAB_MIN;
+  count = MAX(count, n);
+  PoolSlab *s = mem_alloc(p->kind, sizeof(PoolSlab) + count * p->node_size);
+  s->count = count;
+  s->next = p->slabs;
+  p->slabs = s;
+  p->used = 0;
+}
+
+// Makes the next n allocations contiguous when the free list is empty
+static void node_pool_reserve(NodePool *p, size_t n) {
+  if (!p->free_list)
+    node_pool_grow(p, n);
+}
+
+// n zeroed nodes in a row, past the free list: for building in bulk
+static void *node_pool_alloc_run(NodePool *p, size_t n) {
+  node_pool_grow(p, n);
+  char *run = p->slabs->nodes + p->used * p->node_size;
+  memset(run, 0, n * p->node_size);
+  p->used += n;
+  p->live += n;
+  mem_count_elements(p->kind, (int64_t)n * p->weight);
+  return run;
+}
+
+// A zeroed node
+static void *node_pool_alloc(NodePool *p) {
+  void *node = p->free_list;
+  if (node) {
+    p->free_list = *(void **)node;
+  } else {
+    node_pool_grow(p, 1);
+    node = p->slabs->nodes + p->used++ * p->node_size;
+  }
+  memset(node, 0, p->node_size);
+  p->live++;
+  mem_count_elements(p->kind, p->weight);
+  return node;
+}
+
+static void node_pool_release(NodePool *p, void *node) {
+  *(void **)node = p->free_list;
+  p->free_list = node;
+  p->live--;
+  mem_count_elements(p->kind, -p->weight);
+}
+
+// Releases every node at once
+static void node_pool_clear(NodePool *p) {
+  if (!p)
+    return;
+  while (p->slabs) {
+    PoolSlab *next = p->slabs->next;
+    mem_free(p->kind, p->slabs,
+             sizeof(PoolSlab) + p->slabs->count * p->node_size);
+    p->slabs = next;
+  }
+  mem_count_elements(p->kind, -(int64_t)p->live * p->weight);
+  p->used = p->live = 0;
+  p->free_list = NULL;
+}
+
+static void node_pool_free(NodePool *p) {
+  if (!p)
+    return;
+  node_pool_clear(p);
+  mem_free(p->kind, p, sizeof(NodePool));
+}
+
+// Counters of the calling thread
+static MemStats mem_stats_get(MemKind kind) { return mem_stats_tls[kind]; }
+
+// 512 o, 12.3 Ko, 4.56 Mo, 1.20 Go
+static void format_bytes(char *buf, size_t len, int64_t v) {
+  if (v < 1024)
+    snprintf(buf, len, "%" G_GINT64_FORMAT " o", v);
+  else if (v < 1024 * 1024)
+    snprintf(buf, len, "%.1f Ko", v / 1024.0);
+  else if (v < 1024 * 1024 * 1024)
+    snprintf(buf, len, "%.2f Mo", v / (1024.0 * 1024.0));
+  else
+    snprintf(buf, len, "%.2f Go", v / (1024.0 * 1024.0 * 1024.0));
+}
+
 void update_dashboard_stats(AppData *app, int structure_idx, size_t count,
                             double time_ms) {
   if (!app)
@@ -514,42 +1242,305 @@ void update_dashboard_stats(AppData *app, int structure_idx, size_t count,
   else
     snprintf(time_str, sizeof(time_str), "%.2f ms", time_ms);
 
+  // Memory of all live structures of this kind (structure_idx == MemKind),
+  // e.g. both the original and the sorted array
+  char mem_str[64] = "";
+  char *mem_tip = NULL;
+  if (structure_idx >= 0 && structure_idx < NUM_MEM_KINDS) {
+    MemStats m = mem_stats_get((MemKind)structure_idx);
+    char live[32];
+    format_bytes(live, sizeof(live), m.live_bytes);
+    double per_elem = m.elements > 0 ? (double)m.live_bytes / m.elements : 0;
+    snprintf(mem_str, sizeof(mem_str), "\n%s · %.1f o/élém.", live,
+             per_elem);
+    mem_tip = g_strdup_printf("Mémoire vivante : %s (%" G_GINT64_FORMAT
+                              " octets)\n"
+                              "Blocs vivants : %" G_GINT64_FORMAT "\n"
+                              "Éléments : %" G_GINT64_FORMAT "\n"
+                              "Octets par élément : %.1f\n"
+                              "Allocations cumulées : %" G_GUINT64_FORMAT,
+                              live, m.live_bytes, m.live_blocks, m.elements,
+                              per_elem, m.allocations);
+  }
+
+  GtkWidget *lbl = NULL;
   if (structure_idx == 0 && app->lbl_stat_array) {
-    snprintf(buf, sizeof(buf), "%zu Éléments\n%s", count, time_str);
-    gtk_label_set_text(GTK_LABEL(app->lbl_stat_array), buf);
+    lbl = app->lbl_stat_array;
+    snprintf(buf, sizeof(buf), "%zu Éléments\n%s%s", count, time_str,
+             mem_str);
   } else if (structure_idx == 1 && app->lbl_stat_list) {
-    snprintf(buf, sizeof(buf), "%zu Nœuds\n%s", count, time_str);
-    gtk_label_set_text(GTK_LABEL(app->lbl_stat_list), buf);
+    lbl = app->lbl_stat_list;
+    snprintf(buf, sizeof(buf), "%zu Nœuds\n%s%s", count, time_str, mem_str);
   } else if (structure_idx == 2 && app->lbl_stat_tree) {
-    snprintf(buf, sizeof(buf), "%zu Nodes\nDepth: %.0f", count, time_ms);
-    gtk_label_set_text(GTK_LABEL(app->lbl_stat_tree), buf);
+    lbl = app->lbl_stat_tree;
+    snprintf(buf, sizeof(buf), "%zu Nodes\nDepth: %.0f%s", count, time_ms,
+             mem_str);
   } else if (structure_idx == 3 && app->lbl_stat_graph) {
-    snprintf(buf, sizeof(buf), "%zu Sommets\n%s", count, time_str);
-    gtk_label_set_text(GTK_LABEL(app->lbl_stat_graph), buf);
+    lbl = app->lbl_stat_graph;
+    snprintf(buf, sizeof(buf), "%zu Sommets\n%s%s", count, time_str, mem_str);
+  }
+  if (lbl) {
+    gtk_label_set_text(GTK_LABEL(lbl), buf);
+    gtk_widget_set_tooltip_text(lbl, mem_tip);
+  }
+  g_free(mem_tip);
+}
+
+// Compact count: 950, 12.3k, 4.56M, 1.20G
+static void format_count(char *buf, size_t len, uint64_t v) {
+  if (v < 1000)
+    snprintf(buf, len, "%" G_GUINT64_FORMAT, v);
+  else if (v < 1000000)
+    snprintf(buf, len, "%.1fk", v / 1e3);
+  else if (v < 1000000000)
+    snprintf(buf, len, "%.2fM", v / 1e6);
+  else
+    snprintf(buf, len, "%.2fG", v / 1e9);
+}
+
+// Appends the sort's operation counts under the card set by
+// update_dashboard_stats (0=Array, 1=List); the tooltip has the details.
+void update_dashboard_sort_ops(AppData *app, int structure_idx,
+                               const SortStats *ops) {
+  if (!app || !ops)
+    return;
+  GtkWidget *lbl = structure_idx == 0   ? app->lbl_stat_array
+                   : structure_idx == 1 ? app->lbl_stat_list
+                                        : NULL;
+  if (!lbl)
+    return;
+#ifdef SORT_STATS
+  char cmp[32], sw[32], mv[32], bytes[32];
+  format_count(cmp, sizeof(cmp), ops->comparisons);
+  format_count(sw, sizeof(sw), ops->swaps);
+  format_count(mv, sizeof(mv), ops->moves);
+  format_count(bytes, sizeof(bytes), ops->bytes_moved);
+
+  char buf[256];
+  snprintf(buf, sizeof(buf), "%s\n%s cmp · %s éch · %s dépl",
+           gtk_label_get_text(GTK_LABEL(lbl)), cmp, sw, mv);
+  gtk_label_set_text(GTK_LABEL(lbl), buf);
+
+  // Under the memory details set by update_dashboard_stats
+  char *mem_tip = gtk_widget_get_tooltip_text(lbl);
+  char *tip = g_strdup_printf(
+      "%s%s"
+      "Comparaisons : %" G_GUINT64_FORMAT "\n"
+      "Échanges : %" G_GUINT64_FORMAT "\n"
+      "Déplacements : %" G_GUINT64_FORMAT "\n"
+      "Octets déplacés : %s\n"
+      "Allocations du tri : %" G_GUINT64_FORMAT,
+      mem_tip ? mem_tip : "", mem_tip ? "\n\n" : "", ops->comparisons,
+      ops->swaps, ops->moves, bytes, ops->allocations);
+  gtk_widget_set_tooltip_text(lbl, tip);
+  g_free(mem_tip);
+  g_free(tip);
+#else
+  char *mem_tip = gtk_widget_get_tooltip_text(lbl);
+  char *tip = g_strdup_printf("%s%sCompteurs d'opérations : compiler avec "
+                              "-DSORT_STATS",
+                              mem_tip ? mem_tip : "", mem_tip ? "\n\n" : "");
+  gtk_widget_set_tooltip_text(lbl, tip);
+  g_free(mem_tip);
+  g_free(tip);
+#endif
+}
+
+// --- Operation traces ---
+// An animated sort is recorded rather than slowed down: it runs at full speed
+// on the caller's array while hooks in swap(), sort_write(), the comparator
+// and highlight_pseudo_line() append compact events to a trace. The
+// animation window then replays the trace at any speed, forwards or
+// backwards. Values are stored as 32-bit codes: the raw bits of ints and
+// floats, the byte of chars, and for strings an index into the trace's own
+// copy of the strings.
+#define ANIM_FPS 60
+#define ANIM_STEP_MS 500.0          // Delay per event at speed 1.0
+#define ANIM_DEFAULT_SPEED 0.8      // Used while the speed slider is on Instant
+#define TRACE_MAX_EVENTS (1u << 22) // Longer runs end on a jump to the result
+#define TRACE_NONE UINT32_MAX       // Slot outside the array (pivot, buffer)
+#define TRACE_MAGIC "DSTRACE1"
+
+typedef enum { TRACE_COMPARE, TRACE_SWAP, TRACE_WRITE, TRACE_LINE } TraceOp;
+
+// COMPARE and SWAP: slots i and a. WRITE: slot i goes from code b to code a.
+// line is the pseudo-code line highlighted once the event has happened, so
+// rewinding never has to look further back than one event.
+typedef struct {
+  uint8_t op;
+  uint8_t reserved;
+  int16_t line;
+  uint32_t i, a, b;
+} TraceEvent;
+
+struct SortTrace {
+  DataType type;
+  int algo;
+  uint32_t n;
+  uint32_t *initial; // n value codes
+  char **strings;    // DATA_STRING: n copies, indexed by code
+  char *code;        // Pseudo-code shown while replaying
+  TraceEvent *events;
+  size_t count;
+  size_t capacity;
+  gboolean truncated; // Hit TRACE_MAX_EVENTS
+  uint64_t elapsed;
+};
+
+typedef struct {
+  SortTrace *trace;
+  const char *base; // Array being recorded
+  size_t es;
+  int (*cmp)(const void *, const void *);
+  uint32_t *shadow; // Codes as of the last recorded event
+  GHashTable *ids;  // DATA_STRING: string pointer -> code + 1
+  int16_t line;
+} TraceRecorder;
+
+static GPrivate trace_recorder_key = G_PRIVATE_INIT(NULL);
+
+// The recorder of the calling thread, NULL outside animated sorts
+static TraceRecorder *trace_recorder_current(void) {
+  return g_private_get(&trace_recorder_key);
+}
+
+static void trace_push(TraceRecorder *rec, TraceOp op, uint32_t i, uint32_t a,
+                       uint32_t b) {
+  SortTrace *tr = rec->trace;
+  if (tr->count == tr->capacity) {
+    tr->capacity = tr->capacity ? tr->capacity * 2 : 1024;
+    tr->events = g_renew(TraceEvent, tr->events, tr->capacity);
+  }
+  TraceEvent *ev = &tr->events[tr->count++];
+  ev->op = op;
+  ev->reserved = 0;
+  ev->line = rec->line;
+  ev->i = i;
+  ev->a = a;
+  ev->b = b;
+}
+
+// Past the cap the sort runs on unrecorded; the closing writes of
+// trace_record_sync() then jump straight to the result.
+static gboolean trace_open(TraceRecorder *rec) {
+  if (rec->trace->truncated)
+    return FALSE;
+  if (rec->trace->count < TRACE_MAX_EVENTS)
+    return TRUE;
+  rec->trace->truncated = TRUE;
+  return FALSE;
+}
+
+static uint32_t trace_slot(const TraceRecorder *rec, const void *p) {
+  uintptr_t base = (uintptr_t)rec->base, addr = (uintptr_t)p;
+  if (addr < base || addr - base >= (size_t)rec->trace->n * rec->es ||
+      (addr - base) % rec->es)
+    return TRACE_NONE;
+  return (uint32_t)((addr - base) / rec->es);
+}
+
+static uint32_t trace_encode(const TraceRecorder *rec, const void *p) {
+  uint32_t v;
+  switch (rec->trace->type) {
+  case DATA_CHAR:
+    return *(const unsigned char *)p;
+  case DATA_STRING:
+    return GPOINTER_TO_UINT(g_hash_table_lookup(rec->ids, *(char *const *)p)) -
+           1;
+  default:
+    memcpy(&v, p, sizeof(v));
+    return v;
+  }
+}
+
+// Records slot i if it no longer holds the code last seen there
+static void trace_note_write(TraceRecorder *rec, const void *p) {
+  uint32_t i = trace_slot(rec, p);
+  if (i == TRACE_NONE)
+    return;
+  uint32_t v = trace_encode(rec, p);
+  if (v == rec->shadow[i])
+    return;
+  trace_push(rec, TRACE_WRITE, i, v, rec->shadow[i]);
+  rec->shadow[i] = v;
+}
+
+static void trace_note_swap(TraceRecorder *rec, const void *a, const void *b) {
+  if (!trace_open(rec))
+    return;
+  uint32_t i = trace_slot(rec, a), j = trace_slot(rec, b);
+  if (i == TRACE_NONE || j == TRACE_NONE) {
+    trace_note_write(rec, a);
+    trace_note_write(rec, b);
+    return;
+  }
+  trace_push(rec, TRACE_SWAP, i, j, 0);
+  uint32_t t = rec->shadow[i];
+  rec->shadow[i] = rec->shadow[j];
+  rec->shadow[j] = t;
+}
+
+// Stands in for the array's comparator while recording
+static int trace_compare(const void *a, const void *b) {
+  TraceRecorder *rec = trace_recorder_current();
+  STAT_COMPARE();
+  if (trace_open(rec)) {
+    uint32_t i = trace_slot(rec, a), j = trace_slot(rec, b);
+    if (i != TRACE_NONE || j != TRACE_NONE)
+      trace_push(rec, TRACE_COMPARE, i, j, 0);
+  }
+  return rec->cmp(a, b);
+}
+
+// Catches writes made behind the hooks (radix, counting sort) and, after a
+// truncated run, everything past the cap.
+static void trace_record_sync(TraceRecorder *rec) {
+  for (uint32_t i = 0; i < rec->trace->n; i++) {
+    uint32_t v = trace_encode(rec, rec->base + (size_t)i * rec->es);
+    if (v != rec->shadow[i]) {
+      trace_push(rec, TRACE_WRITE, i, v, rec->shadow[i]);
+      rec->shadow[i] = v;
+    }
   }
 }
 
 // Helpers for Pseudo-code (Moved logic to open_animation_window for the UI
 // part)
 
-void set_pseudo_code(AppData *app, const char *code) {
-  if (!app || !app->pseudo_buffer || app->is_benchmarking)
+static void show_pseudo_code(AppData *app, const char *code) {
+  if (!app || !app->pseudo_buffer)
     return;
   gtk_text_buffer_set_text(app->pseudo_buffer, code, -1);
   app->current_pseudo_line = -1;
 }
 
-void highlight_pseudo_line(AppData *app, int line) {
-  if (!app || !app->pseudo_buffer || app->is_benchmarking ||
-      app->animation_speed <= 0)
+// While recording, the code is kept with the trace for the replay.
+void set_pseudo_code(AppData *app, const char *code) {
+  TraceRecorder *rec = trace_recorder_current();
+  if (rec) {
+    g_free(rec->trace->code);
+    rec->trace->code = g_strdup(code);
+    return;
+  }
+  if (!app || app->is_benchmarking)
+    return;
+  show_pseudo_code(app, code);
+}
+
+// Moves the highlight; only the previously highlighted line is re-tagged.
+static void show_pseudo_line(AppData *app, int line) {
+  if (!app || !app->pseudo_buffer)
     return;
   GtkTextIter start, end;
   GtkTextBuffer *buffer = app->pseudo_buffer;
 
-  // Clear previous highlight
-  gtk_text_buffer_get_start_iter(buffer, &start);
-  gtk_text_buffer_get_end_iter(buffer, &end);
-  gtk_text_buffer_remove_tag_by_name(buffer, "highlight", &start, &end);
+  if (app->current_pseudo_line >= 0) {
+    gtk_text_buffer_get_iter_at_line(buffer, &start, app->current_pseudo_line);
+    end = start;
+    gtk_text_iter_forward_to_line_end(&end);
+    gtk_text_buffer_remove_tag_by_name(buffer, "highlight", &start, &end);
+  }
+  app->current_pseudo_line = line;
 
   if (line >= 0) {
     gtk_text_buffer_get_iter_at_line(buffer, &start, line);
@@ -566,9 +1557,15 @@ void highlight_pseudo_line(AppData *app, int line) {
     }
     gtk_text_view_scroll_mark_onscreen(GTK_TEXT_VIEW(app->pseudo_view), mark);
   }
+}
 
-  while (gtk_events_pending())
-    gtk_main_iteration();
+// Called from sort loops: only recorded, the replay moves the highlight.
+void highlight_pseudo_line(AppData *app, int line) {
+  TraceRecorder *rec = trace_recorder_current();
+  if (!app || !rec || rec->line == line || !trace_open(rec))
+    return;
+  rec->line = line;
+  trace_push(rec, TRACE_LINE, 0, 0, 0);
 }
 
 void add_history_entry(AppData *app, const char *text) {
@@ -623,89 +1620,440 @@ void add_history_entry(AppData *app, const char *text) {
 // =============================================================================
 
 static void swap(void *a, void *b, size_t size) {
+  STAT_SWAP(size);
   char temp[size];
   memcpy(temp, a, size);
   memcpy(a, b, size);
   memcpy(b, temp, size);
+  TraceRecorder *rec = trace_recorder_current();
+  if (rec)
+    trace_note_swap(rec, a, b);
 }
 
-Array *create_array(DataType type, size_t size) {
-  Array *array = g_new0(Array, 1);
+// Element store made by the generic sorts, recorded when animated
+static void sort_write(void *dst, const void *src, size_t size) {
+  memcpy(dst, src, size);
+  STAT_MOVE(1, size);
+  TraceRecorder *rec = trace_recorder_current();
+  if (rec && trace_open(rec))
+    trace_note_write(rec, dst);
+}
+
+// strings: arena whose strings the array will hold, NULL for a new one
+static Array *array_new(DataType type, size_t size, StrArena *strings) {
+  Array *array = mem_alloc0(MEM_ARRAY, sizeof(Array));
   array->type = type;
   array->size = size;
   array->element_size = get_element_size(type);
   array->compare_func = get_compare_func(type);
-  array->data = calloc(size, array->element_size);
+  array->data = mem_alloc0(MEM_ARRAY, size * array->element_size);
+  if (type == DATA_STRING)
+    array->strings =
+        strings ? str_arena_ref(strings) : str_arena_new(MEM_ARRAY, FALSE);
+  mem_count_elements(MEM_ARRAY, (int64_t)size);
   return array;
 }
 
+Array *create_array(DataType type, size_t size) {
+  return array_new(type, size, NULL);
+}
+
 void free_array(Array *array) {
   if (!array)
     return;
-  if (array->type == DATA_STRING && array->data) {
-    for (size_t i = 0; i < array->size; i++)
-      g_free(*((char **)array->data + i));
-  }
-  if (array->data)
-    free(array->data);
-  g_free(array);
+  str_arena_unref(array->strings);
+  mem_free(MEM_ARRAY, array->data, array->size * array->element_size);
+  mem_count_elements(MEM_ARRAY, -(int64_t)array->size);
+  mem_free(MEM_ARRAY, array, sizeof(Array));
 }
 
 Array *copy_array(const Array *original) {
+  PROF_SCOPE("copy_array");
   if (!original)
     return NULL;
-  Array *copy = create_array(original->type, original->size);
-  if (original->type == DATA_STRING) {
-    for (size_t i = 0; i < original->size; i++) {
-      const char *src = *((const char **)original->data + i);
-      *((char **)copy->data + i) = src ? g_strdup(src) : NULL;
-    }
-  } else {
-    memcpy(copy->data, original->data, original->size * original->element_size);
-  }
+  // Strings stay in the original's arena, which the copy shares
+  Array *copy = array_new(original->type, original->size, original->strings);
+  memcpy(copy->data, original->data, original->size * original->element_size);
   return copy;
 }
 
-// Helper for random string
-static char *generate_random_string() {
-  int len = 5 + rand() % 6; // 5 to 10 chars
-  char *s = g_malloc(len + 1);
-  for (int i = 0; i < len; i++) {
-    s[i] = 'a' + rand() % 26;
+// Vector extensions of this CPU, probed once (sorting networks, bulk RNG)
+enum { SIMD_UNKNOWN, SIMD_NONE, SIMD_SSE4, SIMD_AVX2 };
+
+static int simd_level(void) {
+  static gint level = SIMD_UNKNOWN;
+  int l = g_atomic_int_get(&level);
+  if (l == SIMD_UNKNOWN) {
+    l = SIMD_NONE;
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+      l = SIMD_AVX2;
+    else if (__builtin_cpu_supports("sse4.1"))
+      l = SIMD_SSE4;
+#endif
+    g_atomic_int_set(&level, l);
   }
-  s[len] = '\0';
-  return s;
+  return l;
 }
 
-void fill_array_random(Array *array) {
-  if (!array)
-    return;
-  srand(time(NULL));
-  for (size_t i = 0; i < array->size; i++) {
-    void *ptr = (char *)array->data + i * array->element_size;
-    switch (array->type) {
-    case DATA_INT:
-      *(int *)ptr = rand() % 10000;
-      break;
-    case DATA_FLOAT:
-      *(float *)ptr = (float)rand() / (float)(RAND_MAX / 1000.0);
-      break;
-    case DATA_CHAR:
-      *(char *)ptr = (char)(33 + rand() % 94);
-      break;
-    case DATA_STRING: {
-      if (*((char **)ptr))
-        g_free(*((char **)ptr));
-      *((char **)ptr) = generate_random_string();
-      break;
-    }
-    }
-  }
+// --- Random numbers ---
+// xoshiro256** (Blackman & Vigna), seeded through splitmix64. Each context
+// owns its generator, so worker threads never share state and a seed
+// reproduces the same data bit for bit.
+
+static uint64_t splitmix64(uint64_t *x) {
+  uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
 }
 
-char *array_to_string(const Array *array, gboolean styled, AppData *app) {
-  if (!array)
-    return g_strdup("");
+static void rng_seed(Rng *rng, uint64_t seed) {
+  for (int i = 0; i < 4; i++)
+    rng->s[i] = splitmix64(&seed);
+}
+
+static inline uint64_t rotl64(uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t rng_next(Rng *rng) {
+  uint64_t *s = rng->s;
+  uint64_t result = rotl64(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl64(s[3], 45);
+  return result;
+}
+
+// Uniform in [0, bound) by multiply-shift (Lemire), no modulo
+static inline uint32_t rng_below(Rng *rng, uint32_t bound) {
+  return (uint32_t)(((rng_next(rng) >> 32) * bound) >> 32);
+}
+
+// Uniform in [0, 1) with 53 random bits
+static inline double rng_double(Rng *rng) {
+  return (double)(rng_next(rng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Bulk output for large fills: four xoshiro256** lanes, seeded from rng, run
+// side by side. The AVX2 path and the scalar one compute the same lanes, so
+// a seed gives the same data on every machine.
+#define RNG_LANES 4
+
+typedef struct {
+  uint64_t s[4][RNG_LANES]; // s[k][lane]
+} RngLanes;
+
+static void rng_lanes_seed(RngLanes *l, Rng *rng) {
+  uint64_t seed = rng_next(rng);
+  for (int k = 0; k < 4; k++)
+    for (int lane = 0; lane < RNG_LANES; lane++)
+      l->s[k][lane] = splitmix64(&seed);
+}
+
+static void rng_lanes_fill_scalar(RngLanes *l, uint64_t *out, size_t blocks) {
+  for (size_t b = 0; b < blocks; b++) {
+    for (int lane = 0; lane < RNG_LANES; lane++) {
+      uint64_t s0 = l->s[0][lane], s1 = l->s[1][lane];
+      uint64_t s2 = l->s[2][lane], s3 = l->s[3][lane];
+      out[b * RNG_LANES + lane] = rotl64(s1 * 5, 7) * 9;
+      uint64_t t = s1 << 17;
+      s2 ^= s0;
+      s3 ^= s1;
+      s1 ^= s2;
+      s0 ^= s3;
+      s2 ^= t;
+      l->s[0][lane] = s0;
+      l->s[1][lane] = s1;
+      l->s[2][lane] = s2;
+      l->s[3][lane] = rotl64(s3, 45);
+    }
+  }
+}
+
+#ifdef HAVE_X86_SIMD
+#define AVX2_ROTL64(v, k)                                                      \
+  _mm256_or_si256(_mm256_slli_epi64((v), (k)), _mm256_srli_epi64((v), 64 - (k)))
+
+// x * 5 and x * 9 are shift-adds: AVX2 has no 64-bit multiply
+__attribute__((target("avx2"))) static void
+rng_lanes_fill_avx2(RngLanes *l, uint64_t *out, size_t blocks) {
+  __m256i s0 = _mm256_loadu_si256((const __m256i *)l->s[0]);
+  __m256i s1 = _mm256_loadu_si256((const __m256i *)l->s[1]);
+  __m256i s2 = _mm256_loadu_si256((const __m256i *)l->s[2]);
+  __m256i s3 = _mm256_loadu_si256((const __m256i *)l->s[3]);
+  for (size_t b = 0; b < blocks; b++) {
+    __m256i x5 = _mm256_add_epi64(_mm256_slli_epi64(s1, 2), s1);
+    __m256i r = AVX2_ROTL64(x5, 7);
+    r = _mm256_add_epi64(_mm256_slli_epi64(r, 3), r);
+    _mm256_storeu_si256((__m256i *)(out + b * RNG_LANES), r);
+    __m256i t = _mm256_slli_epi64(s1, 17);
+    s2 = _mm256_xor_si256(s2, s0);
+    s3 = _mm256_xor_si256(s3, s1);
+    s1 = _mm256_xor_si256(s1, s2);
+    s0 = _mm256_xor_si256(s0, s3);
+    s2 = _mm256_xor_si256(s2, t);
+    s3 = AVX2_ROTL64(s3, 45);
+  }
+  _mm256_storeu_si256((__m256i *)l->s[0], s0);
+  _mm256_storeu_si256((__m256i *)l->s[1], s1);
+  _mm256_storeu_si256((__m256i *)l->s[2], s2);
+  _mm256_storeu_si256((__m256i *)l->s[3], s3);
+}
+#endif
+
+// Fills out[0..n) with random 64-bit words
+static void rng_fill(Rng *rng, uint64_t *out, size_t n) {
+  RngLanes lanes;
+  rng_lanes_seed(&lanes, rng);
+  size_t blocks = n / RNG_LANES;
+#ifdef HAVE_X86_SIMD
+  if (simd_level() == SIMD_AVX2)
+    rng_lanes_fill_avx2(&lanes, out, blocks);
+  else
+#endif
+    rng_lanes_fill_scalar(&lanes, out, blocks);
+  for (size_t i = blocks * RNG_LANES; i < n; i++)
+    out[i] = rng_next(rng);
+}
+
+// Helper for random string, stored in the structure's arena (standalone
+// when strings is NULL)
+static char *generate_random_string(MemKind kind, StrArena *strings,
+                                    Rng *rng) {
+  char s[11];
+  int len = 5 + rng_below(rng, 6); // 5 to 10 chars
+  for (int i = 0; i < len; i++) {
+    s[i] = 'a' + rng_below(rng, 26);
+  }
+  s[len] = '\0';
+  return str_new_len(kind, strings, s, len);
+}
+
+// --- Input distributions ---
+// A generator fills u[0..n) with values in [0,1) whose order gives the shape;
+// store_dist_value then maps them monotonically onto each element type, so
+// a sorted input stays sorted whatever the type. DIST_RANDOM has no
+// generator: it keeps the per-type uniform fill.
+typedef void (*DistGenerator)(double *u, size_t n, Rng *rng);
+
+#define DIST_K 16             // Max displacement in a k-sorted input
+#define DIST_FEW_VALUES 8     // Distinct values of a few-unique input
+#define DIST_ZIPF_RANKS 1000  // Distinct values of a Zipf (s = 1) input
+
+static void dist_gen_sorted(double *u, size_t n, Rng *rng) {
+  for (size_t i = 0; i < n; i++)
+    u[i] = (double)i / n;
+}
+
+static void dist_gen_reversed(double *u, size_t n, Rng *rng) {
+  for (size_t i = 0; i < n; i++)
+    u[i] = (double)(n - 1 - i) / n;
+}
+
+// sqrt(n) ascending runs of sqrt(n) elements
+static void dist_gen_sawtooth(double *u, size_t n, Rng *rng) {
+  size_t period = MAX((size_t)2, (size_t)sqrt((double)n));
+  for (size_t i = 0; i < n; i++)
+    u[i] = (double)(i % period) / period;
+}
+
+// Ascending then descending
+static void dist_gen_organ_pipe(double *u, size_t n, Rng *rng) {
+  size_t half = (n + 1) / 2;
+  for (size_t i = 0; i < n; i++)
+    u[i] = (double)(i < half ? i : n - 1 - i) / half;
+}
+
+// Sorted, then shuffled inside blocks of DIST_K: no element is more than
+// DIST_K - 1 places from its sorted position
+static void dist_gen_k_sorted(double *u, size_t n, Rng *rng) {
+  dist_gen_sorted(u, n, rng);
+  for (size_t b = 0; b < n; b += DIST_K) {
+    size_t len = MIN((size_t)DIST_K, n - b);
+    for (size_t i = len; i > 1; i--) {
+      size_t j = rng_below(rng, (uint32_t)i);
+      double t = u[b + i - 1];
+      u[b + i - 1] = u[b + j];
+      u[b + j] = t;
+    }
+  }
+}
+
+static void dist_gen_few_unique(double *u, size_t n, Rng *rng) {
+  for (size_t i = 0; i < n; i++)
+    u[i] = (double)rng_below(rng, DIST_FEW_VALUES) / DIST_FEW_VALUES;
+}
+
+// Rank r is drawn with probability proportional to 1/r
+static void dist_gen_zipf(double *u, size_t n, Rng *rng) {
+  double cdf[DIST_ZIPF_RANKS], sum = 0;
+  for (int r = 0; r < DIST_ZIPF_RANKS; r++)
+    cdf[r] = (sum += 1.0 / (r + 1));
+  for (size_t i = 0; i < n; i++) {
+    double x = rng_double(rng) * sum;
+    int lo = 0, hi = DIST_ZIPF_RANKS - 1;
+    while (lo < hi) {
+      int mid = (lo + hi) / 2;
+      if (cdf[mid] < x)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    u[i] = (double)lo / DIST_ZIPF_RANKS;
+  }
+}
+
+static void dist_gen_all_equal(double *u, size_t n, Rng *rng) {
+  for (size_t i = 0; i < n; i++)
+    u[i] = 0.5;
+}
+
+static const DistGenerator dist_generators[NUM_DISTS] = {
+    NULL,
+    dist_gen_sorted,
+    dist_gen_reversed,
+    dist_gen_sawtooth,
+    dist_gen_organ_pipe,
+    dist_gen_k_sorted,
+    dist_gen_few_unique,
+    dist_gen_zipf,
+    dist_gen_all_equal};
+
+// Shapes that repeat values: their strings are interned
+static gboolean dist_repeats_values(Distribution dist) {
+  return dist == DIST_FEW_UNIQUE || dist == DIST_ZIPF ||
+         dist == DIST_ALL_EQUAL;
+}
+
+// Command line names (--dists)
+static const char *dist_keys[NUM_DISTS] = {
+    "random",  "sorted",    "reversed", "sawtooth", "organpipe",
+    "ksorted", "fewunique", "zipf",     "equal"};
+static const char *dist_labels[NUM_DISTS] = {
+    "Uniforme",
+    "Tri\xC3\xA9",
+    "Invers\xC3\xA9",
+    "Dents de scie",
+    "Tuyaux d'orgue",
+    "Presque tri\xC3\xA9",
+    "Peu de valeurs",
+    "Zipf",
+    "Toutes \xC3\xA9gales"};
+
+// Six base-26 letters keep string order equal to the order of u
+static void store_dist_value(void *ptr, DataType type, MemKind kind,
+                             StrArena *strings, double u, int int_max,
+                             float float_max) {
+  switch (type) {
+  case DATA_INT:
+    *(int *)ptr = (int)(u * int_max);
+    break;
+  case DATA_FLOAT:
+    *(float *)ptr = (float)(u * float_max);
+    break;
+  case DATA_CHAR:
+    *(char *)ptr = (char)(33 + (int)(u * 94));
+    break;
+  case DATA_STRING: {
+    uint32_t v = (uint32_t)(u * 308915776.0); // 26^6
+    char str[7];
+    for (int k = 5; k >= 0; k--, v /= 26)
+      str[k] = (char)('a' + v % 26);
+    str[6] = '\0';
+    *(char **)ptr = str_new_len(kind, strings, str, 6);
+    break;
+  }
+  }
+}
+
+static GtkWidget *create_dist_combo(void) {
+  GtkWidget *combo = gtk_combo_box_text_new();
+  for (int d = 0; d < NUM_DISTS; d++)
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(combo), dist_labels[d]);
+  gtk_combo_box_set_active(GTK_COMBO_BOX(combo), DIST_RANDOM);
+  gtk_widget_set_tooltip_text(combo, "Distribution des valeurs "
+                                     "g\xC3\xA9n\xC3\xA9r\xC3\xA9"
+                                     "es");
+  return combo;
+}
+
+static Distribution get_dist_combo(GtkWidget *combo) {
+  int d = combo ? gtk_combo_box_get_active(GTK_COMBO_BOX(combo)) : -1;
+  return d >= 0 && d < NUM_DISTS ? (Distribution)d : DIST_RANDOM;
+}
+
+void fill_array_random(Array *array, Rng *rng) {
+  fill_array_dist(array, DIST_RANDOM, rng);
+}
+
+// Uniform ints, floats and chars come from rng_fill in chunks
+#define FILL_CHUNK 1024
+
+void fill_array_dist(Array *array, Distribution dist, Rng *rng) {
+  PROF_SCOPE("fill_array_dist");
+  if (!array)
+    return;
+  // Every string is replaced: the old ones go at once unless shared
+  str_arena_clear(array->strings);
+  str_arena_set_interning(array->strings, dist_repeats_values(dist));
+  DistGenerator gen = dist_generators[dist];
+  if (gen) {
+    double *u = g_new(double, MAX(array->size, 1));
+    gen(u, array->size, rng);
+    for (size_t i = 0; i < array->size; i++) {
+      void *ptr = (char *)array->data + i * array->element_size;
+      store_dist_value(ptr, array->type, MEM_ARRAY, array->strings, u[i],
+                       10000, 1000.0f);
+    }
+    g_free(u);
+    return;
+  }
+  if (array->type == DATA_STRING) {
+    for (size_t i = 0; i < array->size; i++)
+      *((char **)array->data + i) =
+          generate_random_string(MEM_ARRAY, array->strings, rng);
+    return;
+  }
+  uint64_t buf[FILL_CHUNK];
+  for (size_t base = 0; base < array->size; base += FILL_CHUNK) {
+    size_t len = MIN((size_t)FILL_CHUNK, array->size - base);
+    rng_fill(rng, buf, len);
+    switch (array->type) {
+    case DATA_INT: {
+      int *dst = (int *)array->data + base;
+      for (size_t i = 0; i < len; i++)
+        dst[i] = (int)(((buf[i] >> 32) * 10000) >> 32);
+      break;
+    }
+    case DATA_FLOAT: {
+      float *dst = (float *)array->data + base;
+      for (size_t i = 0; i < len; i++)
+        dst[i] = (float)(buf[i] >> 40) * (1000.0f / 16777216.0f);
+      break;
+    }
+    case DATA_CHAR: {
+      char *dst = (char *)array->data + base;
+      for (size_t i = 0; i < len; i++)
+        dst[i] = (char)(33 + (((buf[i] >> 32) * 94) >> 32));
+      break;
+    }
+    default:
+      break;
+    }
+  }
+}
+
+char *array_to_string(const Array *array, gboolean styled, AppData *app) {
+  PROF_SCOPE("array_to_string");
+  if (!array)
+    return g_strdup("");
   GString *str = g_string_sized_new(array->size * 20);
 
   // Performance safeguard
@@ -770,50 +2118,100 @@ char *array_to_string(const Array *array, gboolean styled, AppData *app) {
 //                             ALGORITHMES DE TRI
 // =============================================================================
 
-// Helper to refresh visualization during animation
-static void refresh_sort_visual(AppData *app) {
-  if (app->is_benchmarking || app->animation_speed <= 0)
-    return;
-
-  const char *vis_child =
-      gtk_stack_get_visible_child_name(GTK_STACK(app->view_stack));
-
-  if (g_strcmp0(vis_child, "view_array") == 0 && app->sorted_array) {
-    char *s = array_to_string(app->sorted_array, TRUE, app);
-    set_buffer_markup(app->buffer_array_after, s);
-    g_free(s);
-  } else if (g_strcmp0(vis_child, "view_list") == 0) {
-    gtk_widget_queue_draw(app->list_canvas);
-  }
-
-  // Also refresh the separate animation window if open
-  if (app->anim_canvas) {
-    gtk_widget_queue_draw(app->anim_canvas);
-  }
-
-  // Allow UI to refresh
-  while (gtk_events_pending())
-    gtk_main_iteration();
-
-  g_usleep((gulong)(app->animation_speed * 500000));
-}
+// Pseudo-code of each algorithm, set by sort_array_run() for instant and
+// animated sorts alike
+static const char *sort_pseudo_codes[NUM_SORT_ALGOS] = {
+    "BUBBLE_SORT(Tableau A):\n"
+    "  N = Taille(A)\n"
+    "  Pour i de 0 \xC3\xA0 N-1 faire:\n"
+    "    Echange = Faux\n"
+    "    Pour j de 0 \xC3\xA0 N-i-1 faire:\n"
+    "      Si A[j] > A[j+1] alors:\n"
+    "        Echanger(A[j], A[j+1])\n"
+    "        Echange = Vrai\n"
+    "      Fin Si\n"
+    "    Fin Pour\n"
+    "    Si Echange == Faux alors: STOP\n"
+    "  Fin Pour",
+    "INSERTION_SORT(Tableau A):\n"
+    "  N = Taille(A)\n"
+    "  Pour i de 1 \xC3\xA0 N-1 faire:\n"
+    "    cle = A[i]\n"
+    "    j = i - 1\n"
+    "    Tant que j >= 0 et A[j] > cle faire:\n"
+    "      A[j+1] = A[j]\n"
+    "      j = j - 1\n"
+    "    Fin Tant que\n"
+    "    A[j+1] = cle\n"
+    "  Fin Pour",
+    "SHELL_SORT(Tableau A):\n"
+    "  N = Taille(A)\n"
+    "  Pour ecart de N/2 \xC3\xA0 0 faire:\n"
+    "    Pour i de ecart \xC3\xA0 N-1 faire:\n"
+    "      temp = A[i]\n"
+    "      Pour j de i \xC3\xA0 ecart et A[j-ecart] > temp faire:\n"
+    "        A[j] = A[j-ecart]\n"
+    "      Fin Pour\n"
+    "      A[j] = temp\n"
+    "    Fin Pour\n"
+    "  Fin Pour",
+    "QUICK_SORT(A, bas, haut):\n"
+    "  Si bas < haut alors:\n"
+    "    p = Partition(A, bas, haut)\n"
+    "    QUICK_SORT(A, bas, p - 1)\n"
+    "    QUICK_SORT(A, p + 1, haut)\n"
+    "  Fin Si\n\n"
+    "PARTITION(A, bas, haut):\n"
+    "  pivot = A[haut]\n"
+    "  i = bas\n"
+    "  Pour j de bas \xC3\xA0 haut-1 faire:\n"
+    "    Si A[j] <= pivot alors:\n"
+    "      Echanger(A[i], A[j])\n"
+    "      i = i + 1\n"
+    "    Fin Si\n"
+    "  Fin Pour\n"
+    "  Echanger(A[i], A[haut])\n"
+    "  Retourner i",
+    "INTRO_SORT(A, profondeur):\n"
+    "  Tant que Taille(A) > 24 faire:\n"
+    "    Si profondeur == 0 alors:\n"
+    "      TRI_PAR_TAS(A), Retourner\n"
+    "    profondeur = profondeur - 1\n"
+    "    pivot = Mediane(A[debut], A[milieu], A[fin])\n"
+    "    Partition 3 voies: < pivot | = pivot | > pivot\n"
+    "    INTRO_SORT(plus petite partie)\n"
+    "    A = plus grande partie\n"
+    "  TRI_INSERTION(A)",
+    "RADIX_SORT(Tableau A):\n"
+    "  Convertir chaque valeur en cl\xC3\xA9 non sign\xC3\xA9\x65\n"
+    "  Pour chaque chiffre d (11 bits) faire:\n"
+    "    Compter les occurrences de chaque chiffre\n"
+    "    Cumuler les comptes (positions de d\xC3\xA9part)\n"
+    "    Distribuer A dans B selon le chiffre d\n"
+    "  Reconvertir les cl\xC3\xA9s en valeurs",
+    "TRI_PARALLELE(A, T threads):\n"
+    "  Si Taille(A) <= seuil alors:\n"
+    "    INTRO_SORT(A), Retourner\n"
+    "  Couper A en deux moiti\xC3\xA9s G et D\n"
+    "  En parall\xC3\xA8le: TRI_PARALLELE(G) | TRI_PARALLELE(D)\n"
+    "  Attendre les deux t\xC3\xA2\x63hes\n"
+    "  FUSION(G, D) (d\xC3\xA9\x63oup\xC3\xA9\x65 en "
+    "sous-fusions parall\xC3\xA8les)\n"
+    "  // Threads inactifs: volent des t\xC3\xA2\x63hes aux autres",
+    "TIM_SORT(A):\n"
+    "  Tant que A n'est pas tri\xC3\xA9 faire:\n"
+    "    S\xC3\xA9quence = plus longue suite croissante en t\xC3\xAAte\n"
+    "    Si elle est strictement d\xC3\xA9\x63roissante: l'inverser\n"
+    "    Si Taille < minrun: l'\xC3\xA9tendre par insertion binaire\n"
+    "    Empiler la s\xC3\xA9quence\n"
+    "    Tant que la pile est d\xC3\xA9s\xC3\xA9quilibr\xC3\xA9\x65 faire:\n"
+    "      FUSION(s\xC3\xA9quences voisines) "
+    "(galop si un c\xC3\xB4t\xC3\xA9 domine)\n"
+    "  Fusionner les s\xC3\xA9quences restantes"};
 
 static void bubble_sort(AppData *app, void *data, size_t size,
                         size_t element_size,
                         int (*cmp)(const void *, const void *)) {
-  set_pseudo_code(app, "BUBBLE_SORT(Tableau A):\n"
-                       "  N = Taille(A)\n"
-                       "  Pour i de 0 \xC3\xA0 N-1 faire:\n"
-                       "    Echange = Faux\n"
-                       "    Pour j de 0 \xC3\xA0 N-i-1 faire:\n"
-                       "      Si A[j] > A[j+1] alors:\n"
-                       "        Echanger(A[j], A[j+1])\n"
-                       "        Echange = Vrai\n"
-                       "      Fin Si\n"
-                       "    Fin Pour\n"
-                       "    Si Echange == Faux alors: STOP\n"
-                       "  Fin Pour");
-
   for (size_t i = 0; i < size - 1; i++) {
     gboolean swapped = FALSE;
     highlight_pseudo_line(app, 2);
@@ -826,7 +2224,6 @@ static void bubble_sort(AppData *app, void *data, size_t size,
         swap((char *)data + j * element_size,
              (char *)data + (j + 1) * element_size, element_size);
         swapped = TRUE;
-        refresh_sort_visual(app);
       }
     }
     if (!swapped) {
@@ -840,45 +2237,39 @@ static void bubble_sort(AppData *app, void *data, size_t size,
 static void insertion_sort(AppData *app, void *data, size_t size,
                            size_t element_size,
                            int (*cmp)(const void *, const void *)) {
+  char key[element_size];
   for (size_t i = 1; i < size; i++) {
     highlight_pseudo_line(app, 3);
-    void *key = malloc(element_size);
     memcpy(key, (char *)data + i * element_size, element_size);
     int j = i - 1;
     while (j >= 0 && cmp((char *)data + j * element_size, key) > 0) {
       highlight_pseudo_line(app, 6);
-      memcpy((char *)data + (j + 1) * element_size,
-             (char *)data + j * element_size, element_size);
+      sort_write((char *)data + (j + 1) * element_size,
+                 (char *)data + j * element_size, element_size);
       j--;
-      refresh_sort_visual(app);
     }
-    memcpy((char *)data + (j + 1) * element_size, key, element_size);
-    free(key);
-    refresh_sort_visual(app);
+    sort_write((char *)data + (j + 1) * element_size, key, element_size);
   }
 }
 
 static void shell_sort(AppData *app, void *data, size_t size,
                        size_t element_size,
                        int (*cmp)(const void *, const void *)) {
+  char temp[element_size];
   for (size_t gap = size / 2; gap > 0; gap /= 2) {
     highlight_pseudo_line(app, 2);
     for (size_t i = gap; i < size; i++) {
       highlight_pseudo_line(app, 3);
-      void *temp = malloc(element_size);
       memcpy(temp, (char *)data + i * element_size, element_size);
       size_t j;
       for (j = i;
            j >= gap && cmp((char *)data + (j - gap) * element_size, temp) > 0;
            j -= gap) {
         highlight_pseudo_line(app, 5);
-        memcpy((char *)data + j * element_size,
-               (char *)data + (j - gap) * element_size, element_size);
-        refresh_sort_visual(app);
+        sort_write((char *)data + j * element_size,
+                   (char *)data + (j - gap) * element_size, element_size);
       }
-      memcpy((char *)data + j * element_size, temp, element_size);
-      free(temp);
-      refresh_sort_visual(app);
+      sort_write((char *)data + j * element_size, temp, element_size);
     }
   }
 }
@@ -894,12 +2285,10 @@ static size_t partition(AppData *app, void *data, size_t low, size_t high,
       highlight_pseudo_line(app, 12);
       swap((char *)data + i * es, (char *)data + j * es, es);
       i++;
-      refresh_sort_visual(app);
     }
   }
   highlight_pseudo_line(app, 16);
   swap((char *)data + i * es, (char *)data + high * es, es);
-  refresh_sort_visual(app);
   return i;
 }
 static void qs_rec(AppData *app, void *data, size_t low, size_t high, size_t es,
@@ -916,138 +2305,2310 @@ static void qs_rec(AppData *app, void *data, size_t low, size_t high, size_t es,
   }
 }
 
-uint64_t sort_array_wrapper(AppData *app, Array *array, int algo) {
+// --- Introsort (production engine) ---
+// Quick sort with median-of-3 / ninther pivots and a three-way partition so
+// runs of equal keys are settled in one pass. Small ranges go to insertion
+// sort, the smaller side is recursed into while the larger one is looped on,
+// and a heapsort fallback kicks in once the depth budget is spent, which
+// bounds the worst case to O(n log n) whatever the input shape.
+#define INTRO_INSERTION_CUTOFF 24
+#define INTRO_NINTHER_THRESHOLD 128
+
+static int intro_depth_limit(size_t n) {
+  int depth = 0;
+  while (n > 1) {
+    depth++;
+    n >>= 1;
+  }
+  return 2 * depth;
+}
+
+#define ELEM(i) ((char *)data + (i) * es)
+
+static void sort3_generic(void *data, size_t i, size_t j, size_t k, size_t es,
+                          int (*cmp)(const void *, const void *)) {
+  if (cmp(ELEM(j), ELEM(i)) < 0)
+    swap(ELEM(i), ELEM(j), es);
+  if (cmp(ELEM(k), ELEM(j)) < 0) {
+    swap(ELEM(j), ELEM(k), es);
+    if (cmp(ELEM(j), ELEM(i)) < 0)
+      swap(ELEM(i), ELEM(j), es);
+  }
+}
+
+static void heap_sift_generic(AppData *app, void *data, size_t root, size_t n,
+                              size_t es,
+                              int (*cmp)(const void *, const void *)) {
+  for (;;) {
+    size_t child = 2 * root + 1;
+    if (child >= n)
+      return;
+    if (child + 1 < n && cmp(ELEM(child), ELEM(child + 1)) < 0)
+      child++;
+    if (cmp(ELEM(root), ELEM(child)) >= 0)
+      return;
+    swap(ELEM(root), ELEM(child), es);
+    root = child;
+  }
+}
+
+static void intro_sort_generic(AppData *app, void *data, size_t n, size_t es,
+                               int (*cmp)(const void *, const void *),
+                               int depth) {
+  char pivot[es];
+  while (n > INTRO_INSERTION_CUTOFF) {
+    highlight_pseudo_line(app, 1);
+    if (depth-- == 0) {
+      highlight_pseudo_line(app, 3);
+      for (size_t i = n / 2; i-- > 0;)
+        heap_sift_generic(app, data, i, n, es, cmp);
+      for (size_t end = n - 1; end > 0; end--) {
+        swap(ELEM(0), ELEM(end), es);
+        heap_sift_generic(app, data, 0, end, es, cmp);
+      }
+      return;
+    }
+
+    highlight_pseudo_line(app, 5);
+    size_t mid = n / 2;
+    if (n > INTRO_NINTHER_THRESHOLD) {
+      sort3_generic(data, 0, mid, n - 1, es, cmp);
+      sort3_generic(data, 1, mid - 1, n - 2, es, cmp);
+      sort3_generic(data, 2, mid + 1, n - 3, es, cmp);
+      sort3_generic(data, mid - 1, mid, mid + 1, es, cmp);
+    } else {
+      sort3_generic(data, 0, mid, n - 1, es, cmp);
+    }
+    memcpy(pivot, ELEM(mid), es);
+
+    // Dutch flag: [0,lt) < pivot, [lt,gt) == pivot, [gt,n) > pivot
+    highlight_pseudo_line(app, 6);
+    size_t lt = 0, i = 0, gt = n;
+    while (i < gt) {
+      int c = cmp(ELEM(i), pivot);
+      if (c < 0) {
+        swap(ELEM(lt), ELEM(i), es);
+        lt++;
+        i++;
+      } else if (c > 0) {
+        gt--;
+        swap(ELEM(i), ELEM(gt), es);
+      } else {
+        i++;
+      }
+    }
+
+    highlight_pseudo_line(app, 7);
+    if (lt < n - gt) {
+      intro_sort_generic(app, data, lt, es, cmp, depth);
+      data = ELEM(gt);
+      n -= gt;
+    } else {
+      intro_sort_generic(app, ELEM(gt), n - gt, es, cmp, depth);
+      n = lt;
+    }
+  }
+  highlight_pseudo_line(app, 9);
+  insertion_sort(app, data, n, es, cmp);
+}
+
+#undef ELEM
+
+// Stable merge of data[0,h) and data[h,n) through tmp.
+static void merge_runs_generic(AppData *app, char *data, char *tmp, size_t h,
+                               size_t n, size_t es,
+                               int (*cmp)(const void *, const void *)) {
+  size_t i = 0, j = h, k = 0;
+  STAT_MOVE(n, es); // Into tmp; the copy back counts in sort_write
+  while (i < h && j < n) {
+    if (cmp(data + j * es, data + i * es) < 0)
+      memcpy(tmp + (k++) * es, data + (j++) * es, es);
+    else
+      memcpy(tmp + (k++) * es, data + (i++) * es, es);
+  }
+  memcpy(tmp + k * es, data + i * es, (h - i) * es);
+  k += h - i;
+  memcpy(tmp + k * es, data + j * es, (n - j) * es);
+  for (size_t m = 0; m < n; m++)
+    sort_write(data + m * es, tmp + m * es, es);
+}
+
+// Top-down merge sort, used to animate the divide/merge order of the
+// parallel sort on a single thread.
+static void merge_sort_generic(AppData *app, char *data, char *tmp, size_t n,
+                               size_t es,
+                               int (*cmp)(const void *, const void *)) {
+  if (n < 2)
+    return;
+  size_t h = n / 2;
+  highlight_pseudo_line(app, 4);
+  merge_sort_generic(app, data, tmp, h, es, cmp);
+  merge_sort_generic(app, data + h * es, tmp, n - h, es, cmp);
+  highlight_pseudo_line(app, 6);
+  merge_runs_generic(app, data, tmp, h, n, es, cmp);
+}
+
+// Length of the natural run at data; a strictly descending run is reversed
+// in place, which keeps equal elements in their original order.
+static size_t natural_run_generic(char *data, size_t n, size_t es,
+                                  int (*cmp)(const void *, const void *)) {
+  if (n < 2)
+    return n;
+  size_t len = 2;
+  if (cmp(data + es, data) < 0) {
+    while (len < n && cmp(data + len * es, data + (len - 1) * es) < 0)
+      len++;
+    for (size_t i = 0, j = len - 1; i < j; i++, j--)
+      swap(data + i * es, data + j * es, es);
+  } else {
+    while (len < n && cmp(data + len * es, data + (len - 1) * es) >= 0)
+      len++;
+  }
+  return len;
+}
+
+// Natural merge sort, used to animate Tim Sort: existing runs are kept and
+// neighbouring runs are merged pass after pass until one remains.
+static void tim_sort_generic(AppData *app, char *data, size_t n, size_t es,
+                             int (*cmp)(const void *, const void *)) {
+  char *tmp = malloc(n * es);
+  STAT_ALLOC(1);
+  size_t runs;
+  do {
+    runs = 0;
+    for (size_t lo = 0; lo < n;) {
+      highlight_pseudo_line(app, 2);
+      size_t len1 = natural_run_generic(data + lo * es, n - lo, es, cmp);
+      runs++;
+      if (lo + len1 == n)
+        break;
+      size_t len2 =
+          natural_run_generic(data + (lo + len1) * es, n - lo - len1, es, cmp);
+      highlight_pseudo_line(app, 7);
+      merge_runs_generic(app, data + lo * es, tmp, len1, len1 + len2, es, cmp);
+      lo += len1 + len2;
+    }
+  } while (runs > 1);
+  free(tmp);
+}
+
+// --- Work-stealing task pool ---
+// Fork-join pool for the parallel sort. Each worker owns a deque: it pushes
+// and pops at the bottom, idle workers steal from the top of the others.
+// A thread waiting on a child task keeps running queued tasks meanwhile, so
+// tasks can live on the spawner's stack. The calling thread is worker 0.
+#define POOL_DEQUE_CAPACITY 256
+
+typedef struct TaskPool TaskPool;
+typedef struct PoolTask PoolTask;
+struct PoolTask {
+  void (*run)(TaskPool *pool, int worker, PoolTask *task);
+  gint done;
+};
+
+typedef struct {
+  GMutex lock;
+  PoolTask *items[POOL_DEQUE_CAPACITY];
+  int top;    // Steal end
+  int bottom; // Owner end
+} TaskDeque;
+
+typedef struct {
+  TaskPool *pool;
+  int index;
+} TaskWorker;
+
+struct TaskPool {
+  int num_workers;
+  TaskDeque *deques;
+  TaskWorker *workers;
+  GThread **threads;
+  gint pending;
+  gint shutdown;
+  GMutex idle_lock;
+  GCond idle_cond;
+  gboolean shared;       // Kept for later sorts (see task_pool_acquire)
+  gboolean thread_owned; // One of a benchmark thread's pools
+  GMutex busy;     // Held by the sort using a shared pool
+#ifdef SORT_STATS
+  GMutex stats_lock;
+  SortStats stats; // Counted by workers 1..n-1
+#endif
+};
+
+static void task_pool_run(TaskPool *pool, int worker, PoolTask *task) {
+  PROF_SCOPE("pool_task");
+  task->run(pool, worker, task);
+#ifdef SORT_STATS
+  if (worker != 0) { // Worker 0 is the caller, it counts in place
+    g_mutex_lock(&pool->stats_lock);
+    sort_stats_add(&pool->stats, &sort_stats_tls);
+    g_mutex_unlock(&pool->stats_lock);
+    memset(&sort_stats_tls, 0, sizeof(sort_stats_tls));
+  }
+#endif
+  g_atomic_int_set(&task->done, 1);
+}
+
+// Own deque first (LIFO keeps the working set hot), then steal (FIFO).
+static PoolTask *task_pool_take(TaskPool *pool, int worker) {
+  PoolTask *task = NULL;
+  TaskDeque *own = &pool->deques[worker];
+  g_mutex_lock(&own->lock);
+  if (own->bottom > own->top)
+    task = own->items[--own->bottom];
+  if (own->bottom == own->top)
+    own->bottom = own->top = 0;
+  g_mutex_unlock(&own->lock);
+
+  for (int i = 1; !task && i < pool->num_workers; i++) {
+    TaskDeque *victim = &pool->deques[(worker + i) % pool->num_workers];
+    g_mutex_lock(&victim->lock);
+    if (victim->bottom > victim->top)
+      task = victim->items[victim->top++];
+    g_mutex_unlock(&victim->lock);
+  }
+  if (task)
+    g_atomic_int_add(&pool->pending, -1);
+  return task;
+}
+
+// Runs the task inline when the deque is full.
+static void task_pool_spawn(TaskPool *pool, int worker, PoolTask *task) {
+  TaskDeque *own = &pool->deques[worker];
+  g_atomic_int_set(&task->done, 0);
+  g_mutex_lock(&own->lock);
+  gboolean queued = own->bottom < POOL_DEQUE_CAPACITY;
+  if (queued)
+    own->items[own->bottom++] = task;
+  g_mutex_unlock(&own->lock);
+
+  if (!queued) {
+    task_pool_run(pool, worker, task);
+    return;
+  }
+  g_atomic_int_inc(&pool->pending);
+  g_mutex_lock(&pool->idle_lock);
+  g_cond_signal(&pool->idle_cond);
+  g_mutex_unlock(&pool->idle_lock);
+}
+
+static void task_pool_wait(TaskPool *pool, int worker, PoolTask *task) {
+  while (!g_atomic_int_get(&task->done)) {
+    PoolTask *other = task_pool_take(pool, worker);
+    if (other)
+      task_pool_run(pool, worker, other);
+    else
+      g_thread_yield();
+  }
+}
+
+static gpointer task_pool_worker_main(gpointer data) {
+  TaskWorker *self = (TaskWorker *)data;
+  TaskPool *pool = self->pool;
+  prof_thread_name("sort-worker");
+  while (!g_atomic_int_get(&pool->shutdown)) {
+    PoolTask *task = task_pool_take(pool, self->index);
+    if (task) {
+      task_pool_run(pool, self->index, task);
+      continue;
+    }
+    g_mutex_lock(&pool->idle_lock);
+    while (g_atomic_int_get(&pool->pending) == 0 &&
+           !g_atomic_int_get(&pool->shutdown))
+      g_cond_wait(&pool->idle_cond, &pool->idle_lock);
+    g_mutex_unlock(&pool->idle_lock);
+  }
+  return NULL;
+}
+
+static TaskPool *task_pool_new(int num_workers) {
+  TaskPool *pool = g_new0(TaskPool, 1);
+  pool->num_workers = num_workers;
+  pool->deques = g_new0(TaskDeque, num_workers);
+  pool->workers = g_new0(TaskWorker, num_workers);
+  pool->threads = g_new0(GThread *, num_workers);
+  g_mutex_init(&pool->idle_lock);
+  g_cond_init(&pool->idle_cond);
+  g_mutex_init(&pool->busy);
+#ifdef SORT_STATS
+  g_mutex_init(&pool->stats_lock);
+#endif
+  for (int i = 0; i < num_workers; i++) {
+    g_mutex_init(&pool->deques[i].lock);
+    pool->workers[i].pool = pool;
+    pool->workers[i].index = i;
+  }
+  for (int i = 1; i < num_workers; i++)
+    pool->threads[i] =
+        g_thread_new("sort-worker", task_pool_worker_main, &pool->workers[i]);
+  return pool;
+}
+
+static void task_pool_free(TaskPool *pool) {
+  g_atomic_int_set(&pool->shutdown, 1);
+  g_mutex_lock(&pool->idle_lock);
+  g_cond_broadcast(&pool->idle_cond);
+  g_mutex_unlock(&pool->idle_lock);
+  for (int i = 1; i < pool->num_workers; i++)
+    g_thread_join(pool->threads[i]);
+  for (int i = 0; i < pool->num_workers; i++)
+    g_mutex_clear(&pool->deques[i].lock);
+  g_mutex_clear(&pool->idle_lock);
+  g_cond_clear(&pool->idle_cond);
+  g_mutex_clear(&pool->busy);
+#ifdef SORT_STATS
+  sort_stats_add(&sort_stats_tls, &pool->stats);
+  g_mutex_clear(&pool->stats_lock);
+#endif
+  g_free(pool->threads);
+  g_free(pool->workers);
+  g_free(pool->deques);
+  g_free(pool);
+}
+
+// Pools outlive the sorts: one per worker count, started on first use and
+// shut down at exit, so a sort does not pay for creating its threads. The
+// caller of a sort is worker 0, so a pool serves one sort at a time; a sort
+// that finds it busy (the UI and a benchmark at once) gets a pool of its
+// own for the run. The pools are not counted as the sort's allocations,
+// which would otherwise depend on the sorts that ran before.
+static GMutex shared_pools_lock;
+static GSList *shared_pools;
+
+// A benchmark thread keeps pools of its own, started after its hardware
+// counters: these only follow threads created after them (see
+// perf_counters_open), so the workers of a shared pool would go uncounted.
+static _Thread_local gboolean task_pools_private;
+static _Thread_local GSList *task_pools_local;
+
+static void task_pools_shutdown(void) {
+  g_mutex_lock(&shared_pools_lock);
+  for (GSList *l = shared_pools; l; l = l->next) {
+    TaskPool *pool = (TaskPool *)l->data;
+    g_mutex_lock(&pool->busy); // Lets a running sort finish with it
+    g_mutex_unlock(&pool->busy);
+    task_pool_free(pool);
+  }
+  g_slist_free(shared_pools);
+  shared_pools = NULL;
+  g_mutex_unlock(&shared_pools_lock);
+}
+
+// Makes the calling thread sort with pools of its own until
+// task_pools_end_private()
+static void task_pools_begin_private(void) { task_pools_private = TRUE; }
+
+static void task_pools_end_private(void) {
+  for (GSList *l = task_pools_local; l; l = l->next)
+    task_pool_free((TaskPool *)l->data);
+  g_slist_free(task_pools_local);
+  task_pools_local = NULL;
+  task_pools_private = FALSE;
+}
+
+static TaskPool *task_pool_acquire(int num_workers) {
+  TaskPool *pool = NULL;
+  if (task_pools_private) {
+    for (GSList *l = task_pools_local; l && !pool; l = l->next)
+      if (((TaskPool *)l->data)->num_workers == num_workers)
+        pool = (TaskPool *)l->data;
+    if (!pool) {
+      pool = task_pool_new(num_workers);
+      pool->thread_owned = TRUE;
+      task_pools_local = g_slist_prepend(task_pools_local, pool);
+    }
+    return pool;
+  }
+  g_mutex_lock(&shared_pools_lock);
+  for (GSList *l = shared_pools; l && !pool; l = l->next)
+    if (((TaskPool *)l->data)->num_workers == num_workers)
+      pool = (TaskPool *)l->data;
+  if (!pool) {
+    if (!shared_pools)
+      atexit(task_pools_shutdown);
+    pool = task_pool_new(num_workers);
+    pool->shared = TRUE;
+    shared_pools = g_slist_prepend(shared_pools, pool);
+  }
+  gboolean busy = !g_mutex_trylock(&pool->busy);
+  g_mutex_unlock(&shared_pools_lock);
+  return busy ? task_pool_new(num_workers) : pool;
+}
+
+// Hands the workers' counts to the caller and frees the pool for the next
+// sort
+static void task_pool_release(TaskPool *pool) {
+  if (!pool->shared && !pool->thread_owned) {
+    task_pool_free(pool);
+    return;
+  }
+#ifdef SORT_STATS
+  g_mutex_lock(&pool->stats_lock);
+  sort_stats_add(&sort_stats_tls, &pool->stats);
+  memset(&pool->stats, 0, sizeof(pool->stats));
+  g_mutex_unlock(&pool->stats_lock);
+#endif
+  if (pool->shared)
+    g_mutex_unlock(&pool->busy);
+}
+
+// 0 means "one worker per core".
+static int resolve_sort_threads(int requested) {
+  if (requested > 0)
+    return requested;
+  int cores = (int)g_get_num_processors();
+  return cores > 0 ? cores : 1;
+}
+
+// --- Typed kernels (no animation) ---
+// The generic sorts above go through void*, memcpy-based swaps and an
+// indirect compare call per comparison. When nothing is animated we dispatch
+// once on the element type to these instantiations instead, so comparisons
+// inline and the inner loops never touch the heap.
+
+static inline int compare_cstr(const char *a, const char *b) {
+  if (!a || !b)
+    return (a != NULL) - (b != NULL); // NULL sorts first, like compare_strings
+  return str_compare(a, b);
+}
+
+#define LESS_VALUE(a, b) (STAT_COMPARE(), (a) < (b))
+#define LESS_CSTR(a, b) (STAT_COMPARE(), compare_cstr((a), (b)) < 0)
+
+// --- Sorting networks ---
+// Small int/float partitions are finished with branch-free bitonic sorting
+// networks held in vector registers instead of insertion sort: a column
+// network sorts across registers, a transpose turns columns into sorted
+// rows, and bitonic merges double the sorted length up to the block size.
+// Without SSE4.1 (see simd_level), or off x86, nothing changes.
+#define SIMD_SORT_MIN 8  // Below this, insertion sort wins
+#define SIMD_SORT_MAX 64 // Largest block (AVX2: 8x8 lanes, SSE4.1: 4x4)
+#define SIMD_NET64_COMPARES 632 // Lane compare-exchanges in avx2_sort64
+#define SIMD_NET16_COMPARES 76  // ... and in sse4_sort16
+
+#ifdef HAVE_X86_SIMD
+// Everything below is spelled out on named registers: the networks are
+// fixed, and arrays/loops here would spill to the stack at low -O levels.
+#define AVX2_MINMAX(a, b)                                                      \
+  do {                                                                         \
+    __m256i t_ = (a);                                                          \
+    (a) = _mm256_min_epi32(t_, (b));                                           \
+    (b) = _mm256_max_epi32(t_, (b));                                           \
+  } while (0)
+#define AVX2_REVERSE(v)                                                        \
+  _mm256_permutevar8x32_epi32((v), _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0))
+// Bitonic merge step: a ascending, b ascending -> a holds the low half
+#define AVX2_MINMAX_REV(a, b)                                                  \
+  do {                                                                         \
+    __m256i r_ = AVX2_REVERSE(b);                                              \
+    (b) = _mm256_max_epi32((a), r_);                                           \
+    (a) = _mm256_min_epi32((a), r_);                                           \
+  } while (0)
+
+// Sorts one bitonic register of 8 lanes (half-cleaners at distance 4, 2, 1)
+__attribute__((target("avx2"))) static inline __m256i avx2_clean8(__m256i v) {
+  __m256i p = _mm256_permute2x128_si256(v, v, 1);
+  v = _mm256_blend_epi32(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p), 0xF0);
+  p = _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+  v = _mm256_blend_epi32(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p), 0xCC);
+  p = _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+  return _mm256_blend_epi32(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p),
+                            0xAA);
+}
+
+__attribute__((target("avx2"))) static void avx2_sort64(int32_t *buf) {
+  __m256i v0 = _mm256_loadu_si256((const __m256i *)(buf + 0));
+  __m256i v1 = _mm256_loadu_si256((const __m256i *)(buf + 8));
+  __m256i v2 = _mm256_loadu_si256((const __m256i *)(buf + 16));
+  __m256i v3 = _mm256_loadu_si256((const __m256i *)(buf + 24));
+  __m256i v4 = _mm256_loadu_si256((const __m256i *)(buf + 32));
+  __m256i v5 = _mm256_loadu_si256((const __m256i *)(buf + 40));
+  __m256i v6 = _mm256_loadu_si256((const __m256i *)(buf + 48));
+  __m256i v7 = _mm256_loadu_si256((const __m256i *)(buf + 56));
+
+  // Optimal 19-comparator network on the 8 columns
+  AVX2_MINMAX(v0, v2);
+  AVX2_MINMAX(v1, v3);
+  AVX2_MINMAX(v4, v6);
+  AVX2_MINMAX(v5, v7);
+  AVX2_MINMAX(v0, v4);
+  AVX2_MINMAX(v1, v5);
+  AVX2_MINMAX(v2, v6);
+  AVX2_MINMAX(v3, v7);
+  AVX2_MINMAX(v0, v1);
+  AVX2_MINMAX(v2, v3);
+  AVX2_MINMAX(v4, v5);
+  AVX2_MINMAX(v6, v7);
+  AVX2_MINMAX(v2, v4);
+  AVX2_MINMAX(v3, v5);
+  AVX2_MINMAX(v1, v4);
+  AVX2_MINMAX(v3, v6);
+  AVX2_MINMAX(v1, v2);
+  AVX2_MINMAX(v3, v4);
+  AVX2_MINMAX(v5, v6);
+
+  // 8x8 transpose: sorted columns become sorted rows
+  __m256i t0 = _mm256_unpacklo_epi32(v0, v1);
+  __m256i t1 = _mm256_unpackhi_epi32(v0, v1);
+  __m256i t2 = _mm256_unpacklo_epi32(v2, v3);
+  __m256i t3 = _mm256_unpackhi_epi32(v2, v3);
+  __m256i t4 = _mm256_unpacklo_epi32(v4, v5);
+  __m256i t5 = _mm256_unpackhi_epi32(v4, v5);
+  __m256i t6 = _mm256_unpacklo_epi32(v6, v7);
+  __m256i t7 = _mm256_unpackhi_epi32(v6, v7);
+  __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+  __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+  __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+  __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+  __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+  __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+  __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+  __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+  v0 = _mm256_permute2x128_si256(u0, u4, 0x20);
+  v1 = _mm256_permute2x128_si256(u1, u5, 0x20);
+  v2 = _mm256_permute2x128_si256(u2, u6, 0x20);
+  v3 = _mm256_permute2x128_si256(u3, u7, 0x20);
+  v4 = _mm256_permute2x128_si256(u0, u4, 0x31);
+  v5 = _mm256_permute2x128_si256(u1, u5, 0x31);
+  v6 = _mm256_permute2x128_si256(u2, u6, 0x31);
+  v7 = _mm256_permute2x128_si256(u3, u7, 0x31);
+
+  // Runs of 8 -> 16
+  AVX2_MINMAX_REV(v0, v1);
+  AVX2_MINMAX_REV(v2, v3);
+  AVX2_MINMAX_REV(v4, v5);
+  AVX2_MINMAX_REV(v6, v7);
+  v0 = avx2_clean8(v0);
+  v1 = avx2_clean8(v1);
+  v2 = avx2_clean8(v2);
+  v3 = avx2_clean8(v3);
+  v4 = avx2_clean8(v4);
+  v5 = avx2_clean8(v5);
+  v6 = avx2_clean8(v6);
+  v7 = avx2_clean8(v7);
+
+  // Runs of 16 -> 32. The high halves land with their registers in
+  // reverse order, a rotation that a bitonic sequence tolerates.
+  AVX2_MINMAX_REV(v0, v3);
+  AVX2_MINMAX_REV(v1, v2);
+  AVX2_MINMAX_REV(v4, v7);
+  AVX2_MINMAX_REV(v5, v6);
+  AVX2_MINMAX(v0, v1);
+  AVX2_MINMAX(v2, v3);
+  AVX2_MINMAX(v4, v5);
+  AVX2_MINMAX(v6, v7);
+  v0 = avx2_clean8(v0);
+  v1 = avx2_clean8(v1);
+  v2 = avx2_clean8(v2);
+  v3 = avx2_clean8(v3);
+  v4 = avx2_clean8(v4);
+  v5 = avx2_clean8(v5);
+  v6 = avx2_clean8(v6);
+  v7 = avx2_clean8(v7);
+
+  // Runs of 32 -> 64
+  AVX2_MINMAX_REV(v0, v7);
+  AVX2_MINMAX_REV(v1, v6);
+  AVX2_MINMAX_REV(v2, v5);
+  AVX2_MINMAX_REV(v3, v4);
+  AVX2_MINMAX(v0, v2);
+  AVX2_MINMAX(v1, v3);
+  AVX2_MINMAX(v4, v6);
+  AVX2_MINMAX(v5, v7);
+  AVX2_MINMAX(v0, v1);
+  AVX2_MINMAX(v2, v3);
+  AVX2_MINMAX(v4, v5);
+  AVX2_MINMAX(v6, v7);
+  _mm256_storeu_si256((__m256i *)(buf + 0), avx2_clean8(v0));
+  _mm256_storeu_si256((__m256i *)(buf + 8), avx2_clean8(v1));
+  _mm256_storeu_si256((__m256i *)(buf + 16), avx2_clean8(v2));
+  _mm256_storeu_si256((__m256i *)(buf + 24), avx2_clean8(v3));
+  _mm256_storeu_si256((__m256i *)(buf + 32), avx2_clean8(v4));
+  _mm256_storeu_si256((__m256i *)(buf + 40), avx2_clean8(v5));
+  _mm256_storeu_si256((__m256i *)(buf + 48), avx2_clean8(v6));
+  _mm256_storeu_si256((__m256i *)(buf + 56), avx2_clean8(v7));
+}
+
+#define SSE4_MINMAX(a, b)                                                      \
+  do {                                                                         \
+    __m128i t_ = (a);                                                          \
+    (a) = _mm_min_epi32(t_, (b));                                              \
+    (b) = _mm_max_epi32(t_, (b));                                              \
+  } while (0)
+#define SSE4_MINMAX_REV(a, b)                                                  \
+  do {                                                                         \
+    __m128i r_ = _mm_shuffle_epi32((b), _MM_SHUFFLE(0, 1, 2, 3));              \
+    (b) = _mm_max_epi32((a), r_);                                              \
+    (a) = _mm_min_epi32((a), r_);                                              \
+  } while (0)
+
+__attribute__((target("sse4.1"))) static inline __m128i sse4_clean4(__m128i v) {
+  __m128i p = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+  v = _mm_blend_epi16(_mm_min_epi32(v, p), _mm_max_epi32(v, p), 0xF0);
+  p = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+  return _mm_blend_epi16(_mm_min_epi32(v, p), _mm_max_epi32(v, p), 0xCC);
+}
+
+__attribute__((target("sse4.1"))) static void sse4_sort16(int32_t *buf) {
+  __m128i v0 = _mm_loadu_si128((const __m128i *)(buf + 0));
+  __m128i v1 = _mm_loadu_si128((const __m128i *)(buf + 4));
+  __m128i v2 = _mm_loadu_si128((const __m128i *)(buf + 8));
+  __m128i v3 = _mm_loadu_si128((const __m128i *)(buf + 12));
+  SSE4_MINMAX(v0, v1);
+  SSE4_MINMAX(v2, v3);
+  SSE4_MINMAX(v0, v2);
+  SSE4_MINMAX(v1, v3);
+  SSE4_MINMAX(v1, v2);
+
+  __m128i t0 = _mm_unpacklo_epi32(v0, v1);
+  __m128i t1 = _mm_unpackhi_epi32(v0, v1);
+  __m128i t2 = _mm_unpacklo_epi32(v2, v3);
+  __m128i t3 = _mm_unpackhi_epi32(v2, v3);
+  v0 = _mm_unpacklo_epi64(t0, t2);
+  v1 = _mm_unpackhi_epi64(t0, t2);
+  v2 = _mm_unpacklo_epi64(t1, t3);
+  v3 = _mm_unpackhi_epi64(t1, t3);
+
+  SSE4_MINMAX_REV(v0, v1);
+  SSE4_MINMAX_REV(v2, v3);
+  v0 = sse4_clean4(v0);
+  v1 = sse4_clean4(v1);
+  v2 = sse4_clean4(v2);
+  v3 = sse4_clean4(v3);
+
+  SSE4_MINMAX_REV(v0, v3);
+  SSE4_MINMAX_REV(v1, v2);
+  SSE4_MINMAX(v0, v1);
+  SSE4_MINMAX(v2, v3);
+  _mm_storeu_si128((__m128i *)(buf + 0), sse4_clean4(v0));
+  _mm_storeu_si128((__m128i *)(buf + 4), sse4_clean4(v1));
+  _mm_storeu_si128((__m128i *)(buf + 8), sse4_clean4(v2));
+  _mm_storeu_si128((__m128i *)(buf + 12), sse4_clean4(v3));
+}
+#endif
+
+// Sorts buf[0,n) with the smallest network that fits; FALSE when none does
+// (or n is so small that insertion sort is cheaper), leaving the caller's
+// scalar fallback to handle it.
+static gboolean simd_sort_i32(int32_t *buf, size_t n) {
+#ifdef HAVE_X86_SIMD
+  int level = simd_level();
+  size_t width = level == SIMD_NONE ? 0 : n <= 16 ? 16 : 64;
+  if (n < SIMD_SORT_MIN || n > width || (width == 64 && level != SIMD_AVX2))
+    return FALSE;
+  for (size_t i = n; i < width; i++)
+    buf[i] = INT32_MAX; // Padding sorts last and is dropped
+  if (width == 64)
+    avx2_sort64(buf);
+  else
+    sse4_sort16(buf);
+  STAT_COMPARES(width == 64 ? SIMD_NET64_COMPARES : SIMD_NET16_COMPARES);
+  return TRUE;
+#else
+  (void)buf;
+  (void)n;
+  return FALSE;
+#endif
+}
+
+// Base cases picked up by the typed intro and quick sorts. Floats are
+// sorted as signed ints whose order matches theirs (-0.0 before +0.0).
+static inline gboolean small_sort_int(int *a, size_t n) {
+  int32_t buf[SIMD_SORT_MAX];
+  if (n > SIMD_SORT_MAX)
+    return FALSE;
+  memcpy(buf, a, n * sizeof(int32_t));
+  if (!simd_sort_i32(buf, n))
+    return FALSE;
+  memcpy(a, buf, n * sizeof(int32_t));
+  STAT_MOVE(n, sizeof(int32_t));
+  return TRUE;
+}
+
+static inline int32_t float_order_key(int32_t bits) {
+  return bits ^ (int32_t)((uint32_t)(bits >> 31) >> 1);
+}
+
+static inline gboolean small_sort_float(float *a, size_t n) {
+  int32_t buf[SIMD_SORT_MAX];
+  if (n > SIMD_SORT_MAX)
+    return FALSE;
+  memcpy(buf, a, n * sizeof(float));
+  for (size_t i = 0; i < n; i++)
+    buf[i] = float_order_key(buf[i]);
+  if (!simd_sort_i32(buf, n))
+    return FALSE;
+  for (size_t i = 0; i < n; i++)
+    buf[i] = float_order_key(buf[i]);
+  memcpy(a, buf, n * sizeof(float));
+  STAT_MOVE(n, sizeof(float));
+  return TRUE;
+}
+
+static inline gboolean small_sort_char(char *a, size_t n) {
+  (void)a;
+  (void)n;
+  return FALSE;
+}
+
+static inline gboolean small_sort_str(char **a, size_t n) {
+  (void)a;
+  (void)n;
+  return FALSE;
+}
+
+#define DEFINE_INTRO_SORT(SUFFIX, T, LESS)                                     \
+  static inline void sort3_##SUFFIX(T *a, size_t i, size_t j, size_t k) {     \
+    T t;                                                                       \
+    if (LESS(a[j], a[i])) {                                                    \
+      STAT_SWAP(sizeof(T));                                                    \
+      t = a[i];                                                                \
+      a[i] = a[j];                                                             \
+      a[j] = t;                                                                \
+    }                                                                          \
+    if (LESS(a[k], a[j])) {                                                    \
+      STAT_SWAP(sizeof(T));                                                    \
+      t = a[j];                                                                \
+      a[j] = a[k];                                                             \
+      a[k] = t;                                                                \
+      if (LESS(a[j], a[i])) {                                                  \
+        STAT_SWAP(sizeof(T));                                                  \
+        t = a[i];                                                              \
+        a[i] = a[j];                                                           \
+        a[j] = t;                                                              \
+      }                                                                        \
+    }                                                                          \
+  }                                                                            \
+  static void heap_sift_##SUFFIX(T *a, size_t root, size_t n) {                \
+    T v = a[root];                                                             \
+    for (;;) {                                                                 \
+      size_t child = 2 * root + 1;                                             \
+      if (child >= n)                                                          \
+        break;                                                                 \
+      if (child + 1 < n && LESS(a[child], a[child + 1]))                       \
+        child++;                                                               \
+      if (!LESS(v, a[child]))                                                  \
+        break;                                                                 \
+      a[root] = a[child];                                                      \
+      STAT_MOVE(1, sizeof(T));                                                 \
+      root = child;                                                            \
+    }                                                                          \
+    a[root] = v;                                                               \
+    STAT_MOVE(1, sizeof(T));                                                   \
+  }                                                                            \
+  static void heap_sort_##SUFFIX(T *a, size_t n) {                             \
+    for (size_t i = n / 2; i-- > 0;)                                           \
+      heap_sift_##SUFFIX(a, i, n);                                             \
+    for (size_t end = n - 1; end > 0 && n > 1; end--) {                        \
+      STAT_SWAP(sizeof(T));                                                    \
+      T t = a[0];                                                              \
+      a[0] = a[end];                                                           \
+      a[end] = t;                                                              \
+      heap_sift_##SUFFIX(a, 0, end);                                           \
+    }                                                                          \
+  }                                                                            \
+  static void intro_sort_rec_##SUFFIX(T *a, size_t n, int depth) {            \
+    for (;;) {                                                                 \
+      if (n <= SIMD_SORT_MAX && small_sort_##SUFFIX(a, n))                     \
+        return;                                                                \
+      if (n <= INTRO_INSERTION_CUTOFF)                                         \
+        break;                                                                 \
+      if (depth-- == 0) {                                                      \
+        heap_sort_##SUFFIX(a, n);                                              \
+        return;                                                                \
+      }                                                                        \
+      size_t mid = n / 2;                                                      \
+      if (n > INTRO_NINTHER_THRESHOLD) {                                       \
+        sort3_##SUFFIX(a, 0, mid, n - 1);                                      \
+        sort3_##SUFFIX(a, 1, mid - 1, n - 2);                                  \
+        sort3_##SUFFIX(a, 2, mid + 1, n - 3);                                  \
+        sort3_##SUFFIX(a, mid - 1, mid, mid + 1);                              \
+      } else {                                                                 \
+        sort3_##SUFFIX(a, 0, mid, n - 1);                                      \
+      }                                                                        \
+      T pivot = a[mid];                                                        \
+      size_t lt = 0, i = 0, gt = n;                                            \
+      while (i < gt) {                                                         \
+        T v = a[i];                                                            \
+        if (LESS(v, pivot)) {                                                  \
+          STAT_SWAP(sizeof(T));                                                \
+          a[i++] = a[lt];                                                      \
+          a[lt++] = v;                                                         \
+        } else if (LESS(pivot, v)) {                                           \
+          STAT_SWAP(sizeof(T));                                                \
+          a[i] = a[--gt];                                                      \
+          a[gt] = v;                                                           \
+        } else {                                                               \
+          i++;                                                                 \
+        }                                                                      \
+      }                                                                        \
+      if (lt < n - gt) {                                                       \
+        intro_sort_rec_##SUFFIX(a, lt, depth);                                 \
+        a += gt;                                                               \
+        n -= gt;                                                               \
+      } else {                                                                 \
+        intro_sort_rec_##SUFFIX(a + gt, n - gt, depth);                        \
+        n = lt;                                                                \
+      }                                                                        \
+    }                                                                          \
+    insertion_sort_##SUFFIX(a, n);                                             \
+  }                                                                            \
+  static void intro_sort_##SUFFIX(T *a, size_t n) {                            \
+    intro_sort_rec_##SUFFIX(a, n, intro_depth_limit(n));                       \
+  }
+
+// Parallel merge sort: halves are sorted as pool tasks (leaves use the
+// introsort), results ping-pong between the array and one scratch buffer,
+// and merges are split recursively around a binary-searched pivot so the
+// top levels do not serialize on one core.
+#define PARALLEL_LEAF_MIN 4096
+#define PARALLEL_MERGE_GRAIN 8192
+
+#define DEFINE_PARALLEL_SORT(SUFFIX, T, LESS)                                  \
+  typedef struct {                                                             \
+    PoolTask task;                                                             \
+    T *a;                                                                      \
+    T *b;                                                                      \
+    T *out;                                                                    \
+    size_t na, nb;                                                             \
+  } PMergeJob_##SUFFIX;                                                        \
+  typedef struct {                                                             \
+    PoolTask task;                                                             \
+    T *src;                                                                    \
+    T *dst;                                                                    \
+    size_t n, leaf;                                                            \
+    gboolean to_dst;                                                           \
+  } PSortJob_##SUFFIX;                                                         \
+  static void pmerge_run_##SUFFIX(TaskPool *pool, int w, PoolTask *t) {        \
+    PMergeJob_##SUFFIX *j = (PMergeJob_##SUFFIX *)t;                           \
+    T *a = j->a;                                                               \
+    T *b = j->b;                                                               \
+    T *out = j->out;                                                           \
+    size_t na = j->na, nb = j->nb;                                             \
+    if (na + nb <= PARALLEL_MERGE_GRAIN) {                                     \
+      size_t i = 0, k = 0, o = 0;                                              \
+      STAT_MOVE(na + nb, sizeof(T));                                           \
+      while (i < na && k < nb)                                                 \
+        out[o++] = LESS(b[k], a[i]) ? b[k++] : a[i++];                         \
+      memcpy(out + o, a + i, (na - i) * sizeof(T));                            \
+      memcpy(out + o + na - i, b + k, (nb - k) * sizeof(T));                   \
+      return;                                                                  \
+    }                                                                          \
+    size_t ma, mb, lo, hi;                                                     \
+    if (na >= nb) { /* first b >= a[ma] */                                     \
+      ma = na / 2;                                                             \
+      for (lo = 0, hi = nb; lo < hi;) {                                        \
+        size_t m = lo + (hi - lo) / 2;                                         \
+        if (LESS(b[m], a[ma]))                                                 \
+          lo = m + 1;                                                          \
+        else                                                                   \
+          hi = m;                                                              \
+      }                                                                        \
+      mb = lo;                                                                 \
+    } else { /* first a > b[mb] */                                             \
+      mb = nb / 2;                                                             \
+      for (lo = 0, hi = na; lo < hi;) {                                        \
+        size_t m = lo + (hi - lo) / 2;                                         \
+        if (LESS(b[mb], a[m]))                                                 \
+          hi = m;                                                              \
+        else                                                                   \
+          lo = m + 1;                                                          \
+      }                                                                        \
+      ma = lo;                                                                 \
+    }                                                                          \
+    PMergeJob_##SUFFIX left = {{pmerge_run_##SUFFIX, 0}, a, b, out, ma, mb};   \
+    PMergeJob_##SUFFIX right = {                                               \
+        {pmerge_run_##SUFFIX, 0}, a + ma, b + mb, out + ma + mb, na - ma,      \
+        nb - mb};                                                              \
+    task_pool_spawn(pool, w, &right.task);                                     \
+    task_pool_run(pool, w, &left.task);                                        \
+    task_pool_wait(pool, w, &right.task);                                      \
+  }                                                                            \
+  static void psort_run_##SUFFIX(TaskPool *pool, int w, PoolTask *t) {         \
+    PSortJob_##SUFFIX *j = (PSortJob_##SUFFIX *)t;                             \
+    if (j->n <= j->leaf) {                                                     \
+      intro_sort_##SUFFIX(j->src, j->n);                                       \
+      if (j->to_dst) {                                                         \
+        memcpy(j->dst, j->src, j->n * sizeof(T));                              \
+        STAT_MOVE(j->n, sizeof(T));                                            \
+      }                                                                        \
+      return;                                                                  \
+    }                                                                          \
+    size_t h = j->n / 2;                                                       \
+    PSortJob_##SUFFIX left = {{psort_run_##SUFFIX, 0}, j->src, j->dst, h,      \
+                              j->leaf, !j->to_dst};                            \
+    PSortJob_##SUFFIX right = {{psort_run_##SUFFIX, 0}, j->src + h,            \
+                               j->dst + h, j->n - h, j->leaf, !j->to_dst};     \
+    task_pool_spawn(pool, w, &right.task);                                     \
+    task_pool_run(pool, w, &left.task);                                        \
+    task_pool_wait(pool, w, &right.task);                                      \
+    /* Children left their halves in the buffer we are not writing to */      \
+    T *from = j->to_dst ? j->src : j->dst;                                     \
+    T *into = j->to_dst ? j->dst : j->src;                                     \
+    PMergeJob_##SUFFIX merge = {{pmerge_run_##SUFFIX, 0}, from, from + h,      \
+                                into, h, j->n - h};                            \
+    task_pool_run(pool, w, &merge.task);                                       \
+  }                                                                            \
+  static void parallel_sort_##SUFFIX(T *a, size_t n, int threads) {            \
+    threads = resolve_sort_threads(threads);                                   \
+    if (threads <= 1 || n < 2 * PARALLEL_LEAF_MIN) {                           \
+      intro_sort_##SUFFIX(a, n);                                               \
+      return;                                                                  \
+    }                                                                          \
+    T *tmp = malloc(n * sizeof(T));                                            \
+    STAT_ALLOC(1);                                                             \
+    size_t leaf = n / ((size_t)threads * 8);                                   \
+    if (leaf < PARALLEL_LEAF_MIN)                                              \
+      leaf = PARALLEL_LEAF_MIN;                                                \
+    TaskPool *pool = task_pool_acquire(threads);                               \
+    PSortJob_##SUFFIX root = {{psort_run_##SUFFIX, 0}, a, tmp, n, leaf,        \
+                              FALSE};                                          \
+    task_pool_run(pool, 0, &root.task);                                        \
+    task_pool_release(pool);                                                   \
+    free(tmp);                                                                 \
+  }
+
+// Tim Sort: adaptive, stable natural-run merge sort. Runs shorter than
+// minrun are extended by binary insertion, pending runs sit on a stack whose
+// length invariants keep merges balanced, and a merge switches to galloping
+// (exponential search) once one side keeps winning, so presorted and nearly
+// sorted input costs close to a single linear pass.
+#define TIM_MIN_GALLOP 7
+#define TIM_MAX_PENDING 85
+
+static size_t tim_minrun(size_t n) {
+  size_t r = 0;
+  while (n >= 64) {
+    r |= n & 1;
+    n >>= 1;
+  }
+  return n + r;
+}
+
+#define DEFINE_TIM_SORT(SUFFIX, T, LESS)                                       \
+  /* Leading b[] <= key (or < key when strict), galloping from the left */     \
+  static size_t tim_lead_##SUFFIX(T *b, size_t n, T key, int strict) {         \
+    size_t lo = 0, p = 0;                                                      \
+    while (p < n && (strict ? LESS(b[p], key) : !LESS(key, b[p]))) {           \
+      lo = p + 1;                                                              \
+      p = 2 * p + 1;                                                           \
+    }                                                                          \
+    size_t hi = p < n ? p : n;                                                 \
+    while (lo < hi) {                                                          \
+      size_t m = lo + (hi - lo) / 2;                                           \
+      if (strict ? LESS(b[m], key) : !LESS(key, b[m]))                         \
+        lo = m + 1;                                                            \
+      else                                                                     \
+        hi = m;                                                                \
+    }                                                                          \
+    return lo;                                                                 \
+  }                                                                            \
+  /* Trailing b[] > key (or >= key when !strict), galloping from the right */  \
+  static size_t tim_trail_##SUFFIX(T *b, size_t n, T key, int strict) {        \
+    size_t lo = 0, p = 0;                                                      \
+    while (p < n &&                                                            \
+           (strict ? LESS(key, b[n - 1 - p]) : !LESS(b[n - 1 - p], key))) {    \
+      lo = p + 1;                                                              \
+      p = 2 * p + 1;                                                           \
+    }                                                                          \
+    size_t hi = p < n ? p : n;                                                 \
+    while (lo < hi) {                                                          \
+      size_t m = lo + (hi - lo) / 2;                                           \
+      if (strict ? LESS(key, b[n - 1 - m]) : !LESS(b[n - 1 - m], key))         \
+        lo = m + 1;                                                            \
+      else                                                                     \
+        hi = m;                                                                \
+    }                                                                          \
+    return lo;                                                                 \
+  }                                                                            \
+  /* Merge a[0,len1) with a[len1,len1+len2), copying the left run out */       \
+  static void tim_merge_lo_##SUFFIX(T *a, size_t len1, size_t len2, T *tmp,    \
+                                    size_t *min_gallop) {                      \
+    T *run2 = a + len1;                                                        \
+    size_t i = 0, j = 0, k = 0, mg = *min_gallop;                              \
+    memcpy(tmp, a, len1 * sizeof(T));                                          \
+    /* Plus one write per slot of the merged range */                          \
+    STAT_MOVE(2 * len1 + len2, sizeof(T));                                     \
+    while (i < len1 && j < len2) {                                             \
+      size_t c1 = 0, c2 = 0;                                                   \
+      while (i < len1 && j < len2) {                                           \
+        if (LESS(run2[j], tmp[i])) {                                           \
+          a[k++] = run2[j++];                                                  \
+          c1 = 0;                                                              \
+          if (++c2 >= mg)                                                      \
+            break;                                                             \
+        } else {                                                               \
+          a[k++] = tmp[i++];                                                   \
+          c2 = 0;                                                              \
+          if (++c1 >= mg)                                                      \
+            break;                                                             \
+        }                                                                      \
+      }                                                                        \
+      while (i < len1 && j < len2) {                                           \
+        c1 = tim_lead_##SUFFIX(tmp + i, len1 - i, run2[j], 0);                 \
+        memcpy(a + k, tmp + i, c1 * sizeof(T));                                \
+        k += c1;                                                               \
+        i += c1;                                                               \
+        if (i == len1)                                                         \
+          break;                                                               \
+        a[k++] = run2[j++];                                                    \
+        if (j == len2)                                                         \
+          break;                                                               \
+        c2 = tim_lead_##SUFFIX(run2 + j, len2 - j, tmp[i], 1);                 \
+        memmove(a + k, run2 + j, c2 * sizeof(T));                              \
+        k += c2;                                                               \
+        j += c2;                                                               \
+        if (j == len2)                                                         \
+          break;                                                               \
+        a[k++] = tmp[i++];                                                     \
+        if (c1 < TIM_MIN_GALLOP && c2 < TIM_MIN_GALLOP) {                      \
+          mg++;                                                                \
+          break;                                                               \
+        }                                                                      \
+        if (mg > 1)                                                            \
+          mg--;                                                                \
+      }                                                                        \
+    }                                                                          \
+    memcpy(a + k, tmp + i, (len1 - i) * sizeof(T));                            \
+    *min_gallop = mg;                                                          \
+  }                                                                            \
+  /* Same merge from the right end, copying the (shorter) right run out */     \
+  static void tim_merge_hi_##SUFFIX(T *a, size_t len1, size_t len2, T *tmp,    \
+                                    size_t *min_gallop) {                      \
+    size_t i = len1, j = len2, k = len1 + len2, mg = *min_gallop;              \
+    memcpy(tmp, a + len1, len2 * sizeof(T));                                   \
+    STAT_MOVE(len1 + 2 * len2, sizeof(T));                                     \
+    while (i > 0 && j > 0) {                                                   \
+      size_t c1 = 0, c2 = 0;                                                   \
+      while (i > 0 && j > 0) {                                                 \
+        if (LESS(tmp[j - 1], a[i - 1])) {                                      \
+          a[--k] = a[--i];                                                     \
+          c2 = 0;                                                              \
+          if (++c1 >= mg)                                                      \
+            break;                                                             \
+        } else {                                                               \
+          a[--k] = tmp[--j];                                                   \
+          c1 = 0;                                                              \
+          if (++c2 >= mg)                                                      \
+            break;                                                             \
+        }                                                                      \
+      }                                                                        \
+      while (i > 0 && j > 0) {                                                 \
+        c1 = tim_trail_##SUFFIX(a, i, tmp[j - 1], 1);                          \
+        memmove(a + k - c1, a + i - c1, c1 * sizeof(T));                       \
+        k -= c1;                                                               \
+        i -= c1;                                                               \
+        if (i == 0)                                                            \
+          break;                                                               \
+        a[--k] = tmp[--j];                                                     \
+        if (j == 0)                                                            \
+          break;                                                               \
+        c2 = tim_trail_##SUFFIX(tmp, j, a[i - 1], 0);                          \
+        memcpy(a + k - c2, tmp + j - c2, c2 * sizeof(T));                      \
+        k -= c2;                                                               \
+        j -= c2;                                                               \
+        if (j == 0)                                                            \
+          break;                                                               \
+        a[--k] = a[--i];                                                       \
+        if (c1 < TIM_MIN_GALLOP && c2 < TIM_MIN_GALLOP) {                      \
+          mg++;                                                                \
+          break;                                                               \
+        }                                                                      \
+        if (mg > 1)                                                            \
+          mg--;                                                                \
+      }                                                                        \
+    }                                                                          \
+    memcpy(a, tmp, j * sizeof(T));                                             \
+    *min_gallop = mg;                                                          \
+  }                                                                            \
+  /* Merge two adjacent runs, first trimming what is already in place */       \
+  static void tim_merge_##SUFFIX(T *a, size_t len1, size_t len2, T *tmp,       \
+                                 size_t *min_gallop) {                         \
+    size_t skip = tim_lead_##SUFFIX(a, len1, a[len1], 0);                      \
+    a += skip;                                                                 \
+    len1 -= skip;                                                              \
+    if (len1 == 0)                                                             \
+      return;                                                                  \
+    len2 -= tim_trail_##SUFFIX(a + len1, len2, a[len1 - 1], 0);                \
+    if (len2 == 0)                                                             \
+      return;                                                                  \
+    if (len1 <= len2)                                                          \
+      tim_merge_lo_##SUFFIX(a, len1, len2, tmp, min_gallop);                   \
+    else                                                                       \
+      tim_merge_hi_##SUFFIX(a, len1, len2, tmp, min_gallop);                   \
+  }                                                                            \
+  /* Length of the run at a, reversing it in place if strictly descending */   \
+  static size_t tim_count_run_##SUFFIX(T *a, size_t n) {                       \
+    if (n < 2)                                                                 \
+      return n;                                                                \
+    size_t len = 2;                                                            \
+    if (LESS(a[1], a[0])) {                                                    \
+      while (len < n && LESS(a[len], a[len - 1]))                              \
+        len++;                                                                 \
+      for (size_t i = 0, j = len - 1; i < j; i++, j--) {                       \
+        STAT_SWAP(sizeof(T));                                                  \
+        T t = a[i];                                                            \
+        a[i] = a[j];                                                           \
+        a[j] = t;                                                              \
+      }                                                                        \
+    } else {                                                                   \
+      while (len < n && !LESS(a[len], a[len - 1]))                             \
+        len++;                                                                 \
+    }                                                                          \
+    return len;                                                                \
+  }                                                                            \
+  /* Extend the sorted prefix a[0,start) to a[0,n) by binary insertion */      \
+  static void tim_binary_insertion_##SUFFIX(T *a, size_t n, size_t start) {    \
+    for (size_t i = start; i < n; i++) {                                       \
+      T key = a[i];                                                            \
+      size_t lo = 0, hi = i;                                                   \
+      while (lo < hi) {                                                        \
+        size_t m = lo + (hi - lo) / 2;                                         \
+        if (LESS(key, a[m]))                                                   \
+          hi = m;                                                              \
+        else                                                                   \
+          lo = m + 1;                                                          \
+      }                                                                        \
+      memmove(a + lo + 1, a + lo, (i - lo) * sizeof(T));                       \
+      a[lo] = key;                                                             \
+      STAT_MOVE(i - lo + 1, sizeof(T));                                        \
+    }                                                                          \
+  }                                                                            \
+  static void tim_sort_##SUFFIX(T *a, size_t n) {                              \
+    if (n < 2)                                                                 \
+      return;                                                                  \
+    size_t base[TIM_MAX_PENDING], len[TIM_MAX_PENDING];                        \
+    size_t min_gallop = TIM_MIN_GALLOP, minrun = tim_minrun(n);                \
+    int top = 0;                                                               \
+    T *tmp = malloc((n / 2 + 1) * sizeof(T));                                  \
+    STAT_ALLOC(1);                                                             \
+    for (size_t lo = 0; lo < n;) {                                             \
+      size_t run = tim_count_run_##SUFFIX(a + lo, n - lo);                     \
+      if (run < minrun) {                                                      \
+        size_t force = minrun < n - lo ? minrun : n - lo;                      \
+        tim_binary_insertion_##SUFFIX(a + lo, force, run);                     \
+        run = force;                                                           \
+      }                                                                        \
+      base[top] = lo;                                                          \
+      len[top++] = run;                                                        \
+      lo += run;                                                               \
+      /* Keep len[i-2] > len[i-1] + len[i] and len[i-1] > len[i] */            \
+      while (top > 1) {                                                        \
+        int m = top - 2;                                                       \
+        if ((m > 0 && len[m - 1] <= len[m] + len[m + 1]) ||                    \
+            (m > 1 && len[m - 2] <= len[m - 1] + len[m])) {                    \
+          if (len[m - 1] < len[m + 1])                                         \
+            m--;                                                               \
+        } else if (lo < n && len[m] > len[m + 1]) {                            \
+          break;                                                               \
+        }                                                                      \
+        tim_merge_##SUFFIX(a + base[m], len[m], len[m + 1], tmp, &min_gallop); \
+        len[m] += len[m + 1];                                                  \
+        if (m == top - 3) {                                                    \
+          base[m + 1] = base[m + 2];                                           \
+          len[m + 1] = len[m + 2];                                             \
+        }                                                                      \
+        top--;                                                                 \
+      }                                                                        \
+    }                                                                          \
+    free(tmp);                                                                 \
+  }
+
+
+#define DEFINE_TYPED_SORTS(SUFFIX, T, LESS)                                    \
+  static void bubble_sort_##SUFFIX(T *a, size_t n) {                           \
+    for (size_t i = 0; i + 1 < n; i++) {                                       \
+      gboolean swapped = FALSE;                                                \
+      for (size_t j = 0; j < n - i - 1; j++) {                                 \
+        if (LESS(a[j + 1], a[j])) {                                            \
+          STAT_SWAP(sizeof(T));                                                \
+          T t = a[j];                                                          \
+          a[j] = a[j + 1];                                                     \
+          a[j + 1] = t;                                                        \
+          swapped = TRUE;                                                      \
+        }                                                                      \
+      }                                                                        \
+      if (!swapped)                                                            \
+        break;                                                                 \
+    }                                                                          \
+  }                                                                            \
+  static void insertion_sort_##SUFFIX(T *a, size_t n) {                        \
+    for (size_t i = 1; i < n; i++) {                                           \
+      T key = a[i];                                                            \
+      size_t j = i;                                                            \
+      while (j > 0 && LESS(key, a[j - 1])) {                                   \
+        a[j] = a[j - 1];                                                       \
+        STAT_MOVE(1, sizeof(T));                                               \
+        j--;                                                                   \
+      }                                                                        \
+      a[j] = key;                                                              \
+      STAT_MOVE(1, sizeof(T));                                                 \
+    }                                                                          \
+  }                                                                            \
+  DEFINE_INTRO_SORT(SUFFIX, T, LESS)                                           \
+  DEFINE_PARALLEL_SORT(SUFFIX, T, LESS)                                        \
+  DEFINE_TIM_SORT(SUFFIX, T, LESS)                                             \
+  static void shell_sort_##SUFFIX(T *a, size_t n) {                            \
+    for (size_t gap = n / 2; gap > 0; gap /= 2) {                              \
+      for (size_t i = gap; i < n; i++) {                                       \
+        T temp = a[i];                                                         \
+        size_t j;                                                              \
+        for (j = i; j >= gap && LESS(temp, a[j - gap]); j -= gap) {            \
+          a[j] = a[j - gap];                                                   \
+          STAT_MOVE(1, sizeof(T));                                             \
+        }                                                                      \
+        a[j] = temp;                                                           \
+        STAT_MOVE(1, sizeof(T));                                               \
+      }                                                                        \
+    }                                                                          \
+  }                                                                            \
+  /* Same Lomuto scheme as qs_rec; recursing into the smaller side and */      \
+  /* looping on the larger one bounds the stack to O(log n). Ranges that */    \
+  /* fit a sorting network (ints/floats) are finished there. */                \
+  static void quick_sort_##SUFFIX(T *a, size_t low, size_t high) {            \
+    while (low < high) {                                                       \
+      if (high - low < SIMD_SORT_MAX &&                                        \
+          small_sort_##SUFFIX(a + low, high - low + 1))                        \
+        return;                                                                \
+      T pivot = a[high];                                                       \
+      size_t i = low;                                                          \
+      for (size_t j = low; j < high; j++) {                                    \
+        if (!LESS(pivot, a[j])) {                                              \
+          STAT_SWAP(sizeof(T));                                                \
+          T t = a[i];                                                          \
+          a[i] = a[j];                                                         \
+          a[j] = t;                                                            \
+          i++;                                                                 \
+        }                                                                      \
+      }                                                                        \
+      a[high] = a[i];                                                          \
+      a[i] = pivot;                                                            \
+      STAT_SWAP(sizeof(T));                                                    \
+      if (i - low < high - i) {                                                \
+        if (i > low)                                                           \
+          quick_sort_##SUFFIX(a, low, i - 1);                                  \
+        low = i + 1;                                                           \
+      } else {                                                                 \
+        if (i < high)                                                          \
+          quick_sort_##SUFFIX(a, i + 1, high);                                 \
+        if (i == 0)                                                            \
+          break;                                                               \
+        high = i - 1;                                                          \
+      }                                                                        \
+    }                                                                          \
+  }                                                                            \
+  static gboolean sort_typed_##SUFFIX(T *a, size_t n, int algo,               \
+                                      int threads) {                           \
+    switch (algo) {                                                            \
+    case 0:                                                                    \
+      bubble_sort_##SUFFIX(a, n);                                              \
+      return TRUE;                                                             \
+    case 1:                                                                    \
+      insertion_sort_##SUFFIX(a, n);                                           \
+      return TRUE;                                                             \
+    case 2:                                                                    \
+      shell_sort_##SUFFIX(a, n);                                               \
+      return TRUE;                                                             \
+    case 3:                                                                    \
+      quick_sort_##SUFFIX(a, 0, n - 1);                                        \
+      return TRUE;                                                             \
+    case 4:                                                                    \
+      intro_sort_##SUFFIX(a, n);                                               \
+      return TRUE;                                                             \
+    case 6:                                                                    \
+      parallel_sort_##SUFFIX(a, n, threads);                                   \
+      return TRUE;                                                             \
+    case 7:                                                                    \
+      tim_sort_##SUFFIX(a, n);                                                 \
+      return TRUE;                                                             \
+    }                                                                          \
+    return FALSE;                                                              \
+  }
+
+DEFINE_TYPED_SORTS(int, int, LESS_VALUE)
+DEFINE_TYPED_SORTS(float, float, LESS_VALUE)
+DEFINE_TYPED_SORTS(char, char, LESS_VALUE)
+DEFINE_TYPED_SORTS(str, char *, LESS_CSTR)
+
+// Animation needs the per-step hooks of the generic sorts; everything else
+// (instant sorts, benchmarks) takes the typed kernels with no hooks at all.
+static gboolean sort_is_animated(AppData *app) {
+  return app && trace_recorder_current() != NULL;
+}
+
+// --- Radix Sort (LSD) ---
+// Fixed-width keys are sorted without a single comparison: ints and floats
+// are mapped to order-preserving unsigned 32-bit keys and distributed in
+// three 11-bit passes through one scratch buffer; chars get a plain counting
+// sort. All histograms are built in one read, and a pass is skipped when
+// every key shares the same digit (common with rand() % 10000 data).
+#define RADIX_BITS 11
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_PASSES 3
+
+static inline uint32_t radix_key_float(uint32_t bits) {
+  return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+}
+static inline uint32_t radix_unkey_float(uint32_t key) {
+  return (key & 0x80000000u) ? key & 0x7FFFFFFFu : ~key;
+}
+
+// Sorts unsigned keys; returns the buffer holding the result.
+static uint32_t *radix_sort_u32(AppData *app, uint32_t *a, uint32_t *tmp,
+                                size_t n) {
+  size_t hist[RADIX_PASSES][RADIX_BUCKETS] = {{0}}; // 48 KiB, kept reentrant
+  for (size_t i = 0; i < n; i++) {
+    uint32_t k = a[i];
+    hist[0][k & (RADIX_BUCKETS - 1)]++;
+    hist[1][(k >> RADIX_BITS) & (RADIX_BUCKETS - 1)]++;
+    hist[2][k >> (2 * RADIX_BITS)]++;
+  }
+
+  for (int pass = 0; pass < RADIX_PASSES; pass++) {
+    int shift = pass * RADIX_BITS;
+    size_t *h = hist[pass];
+    if (h[(a[0] >> shift) & (RADIX_BUCKETS - 1)] == n)
+      continue; // Every key has the same digit
+
+    highlight_pseudo_line(app, 3);
+    size_t sum = 0;
+    for (int b = 0; b < RADIX_BUCKETS; b++) {
+      size_t c = h[b];
+      h[b] = sum;
+      sum += c;
+    }
+    highlight_pseudo_line(app, 4);
+    for (size_t i = 0; i < n; i++) {
+      uint32_t k = a[i];
+      tmp[h[(k >> shift) & (RADIX_BUCKETS - 1)]++] = k;
+    }
+    STAT_MOVE(n, sizeof(uint32_t));
+    uint32_t *t = a;
+    a = tmp;
+    tmp = t;
+  }
+  return a;
+}
+
+static void counting_sort_chars(char *a, size_t n) {
+  size_t count[256] = {0};
+  for (size_t i = 0; i < n; i++)
+    count[(int)a[i] - CHAR_MIN]++;
+  size_t k = 0;
+  for (int b = 0; b < 256; b++)
+    for (size_t c = count[b]; c > 0; c--)
+      a[k++] = (char)(b + CHAR_MIN);
+  STAT_MOVE(n, 1);
+}
+
+// --- String sort (multikey quicksort on cached prefixes) ---
+// Each string is paired with the next 8 bytes at the current depth, packed
+// big-endian so an integer compare matches strcmp. Partitioning only touches
+// this contiguous key array; a string is dereferenced again only when its
+// group ties on all 8 bytes and moves 8 bytes deeper, so shared prefixes are
+// never re-compared from byte 0.
+#define MKQS_INSERTION_CUTOFF 16
+
+typedef struct {
+  uint64_t key;
+  char *str;
+} StrKey;
+
+static inline uint64_t str_prefix8(const char *s, size_t depth) {
+  uint64_t key = 0;
+  s += depth;
+  for (int i = 0; i < 8 && s[i]; i++)
+    key |= (uint64_t)(unsigned char)s[i] << (56 - 8 * i);
+  return key;
+}
+
+// The window ended inside the string when its last byte is NUL.
+static inline gboolean str_key_terminated(uint64_t key) {
+  return (key & 0xFF) == 0;
+}
+
+static inline gboolean strkey_less(const StrKey *a, const StrKey *b,
+                                   size_t depth) {
+  STAT_COMPARE();
+  if (a->key != b->key)
+    return a->key < b->key;
+  if (str_key_terminated(a->key))
+    return FALSE;
+  return strcmp(a->str + depth + 8, b->str + depth + 8) < 0;
+}
+
+static void mkqs_rec(StrKey *a, size_t n, size_t depth) {
+  while (n > MKQS_INSERTION_CUTOFF) {
+    size_t mid = n / 2;
+    uint64_t k0 = a[0].key, k1 = a[mid].key, k2 = a[n - 1].key;
+    uint64_t pivot = (k0 < k1) ? ((k1 < k2) ? k1 : (k0 < k2) ? k2 : k0)
+                               : ((k0 < k2) ? k0 : (k1 < k2) ? k2 : k1);
+
+    size_t lt = 0, i = 0, gt = n;
+    while (i < gt) {
+      StrKey v = a[i];
+      STAT_COMPARE();
+      if (v.key < pivot) {
+        STAT_SWAP(sizeof(StrKey));
+        a[i++] = a[lt];
+        a[lt++] = v;
+      } else if (v.key > pivot) {
+        STAT_SWAP(sizeof(StrKey));
+        a[i] = a[--gt];
+        a[gt] = v;
+      } else {
+        i++;
+      }
+    }
+
+    // Ties on the whole window go one window deeper (unless they ended)
+    if (gt - lt > 1 && !str_key_terminated(pivot)) {
+      for (size_t k = lt; k < gt; k++)
+        a[k].key = str_prefix8(a[k].str, depth + 8);
+      mkqs_rec(a + lt, gt - lt, depth + 8);
+    }
+    if (lt < n - gt) {
+      mkqs_rec(a, lt, depth);
+      a += gt;
+      n -= gt;
+    } else {
+      mkqs_rec(a + gt, n - gt, depth);
+      n = lt;
+    }
+  }
+  for (size_t i = 1; i < n; i++) {
+    StrKey v = a[i];
+    size_t j = i;
+    while (j > 0 && strkey_less(&v, &a[j - 1], depth)) {
+      a[j] = a[j - 1];
+      STAT_MOVE(1, sizeof(StrKey));
+      j--;
+    }
+    a[j] = v;
+    STAT_MOVE(1, sizeof(StrKey));
+  }
+}
+
+static void string_sort(char **strs, size_t n) {
+  // NULL entries go first, like compare_strings
+  size_t nulls = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (!strs[i]) {
+      strs[i] = strs[nulls];
+      strs[nulls++] = NULL;
+    }
+  }
+  strs += nulls;
+  n -= nulls;
+
+  StrKey *keys = malloc(n * sizeof(StrKey));
+  STAT_ALLOC(1);
+  STAT_MOVE(2 * n, sizeof(char *)); // Into the keys and back
+  for (size_t i = 0; i < n; i++) {
+    keys[i].str = strs[i];
+    keys[i].key = str_prefix8(strs[i], 0);
+  }
+  mkqs_rec(keys, n, 0);
+  for (size_t i = 0; i < n; i++)
+    strs[i] = keys[i].str;
+  free(keys);
+}
+
+static void radix_sort_array(AppData *app, Array *array) {
+  size_t n = array->size;
+  if (array->type == DATA_CHAR) {
+    highlight_pseudo_line(app, 1);
+    counting_sort_chars((char *)array->data, n);
+    return;
+  }
+  if (array->type == DATA_STRING) {
+    // Strings are variable-width: MSD order through the multikey quicksort
+    if (sort_is_animated(app))
+      intro_sort_generic(app, array->data, n, array->element_size,
+                         array->compare_func, intro_depth_limit(n));
+    else
+      string_sort((char **)array->data, n);
+    return;
+  }
+
+  // DATA_INT / DATA_FLOAT share the 32-bit key path
+  G_STATIC_ASSERT(sizeof(int) == sizeof(uint32_t));
+  G_STATIC_ASSERT(sizeof(float) == sizeof(uint32_t));
+  uint32_t *keys = (uint32_t *)array->data;
+  gboolean is_float = (array->type == DATA_FLOAT);
+
+  highlight_pseudo_line(app, 1);
+  for (size_t i = 0; i < n; i++)
+    keys[i] = is_float ? radix_key_float(keys[i]) : keys[i] ^ 0x80000000u;
+
+  uint32_t *tmp = malloc(n * sizeof(uint32_t));
+  STAT_ALLOC(1);
+  uint32_t *sorted = radix_sort_u32(app, keys, tmp, n);
+  if (sorted != keys) {
+    memcpy(keys, sorted, n * sizeof(uint32_t));
+    STAT_MOVE(n, sizeof(uint32_t));
+  }
+  free(tmp);
+
+  highlight_pseudo_line(app, 6);
+  for (size_t i = 0; i < n; i++)
+    keys[i] = is_float ? radix_unkey_float(keys[i]) : keys[i] ^ 0x80000000u;
+}
+
+// Returns FALSE when the caller must fall back to the generic path.
+static gboolean sort_array_typed(Array *array, int algo, int threads) {
+  if (algo == 5) {
+    radix_sort_array(NULL, array);
+    return TRUE;
+  }
+  switch (array->type) {
+  case DATA_INT:
+    return sort_typed_int((int *)array->data, array->size, algo, threads);
+  case DATA_FLOAT:
+    return sort_typed_float((float *)array->data, array->size, algo, threads);
+  case DATA_CHAR:
+    return sort_typed_char((char *)array->data, array->size, algo, threads);
+  case DATA_STRING:
+    return sort_typed_str((char **)array->data, array->size, algo, threads);
+  }
+  return FALSE;
+}
+
+// Algorithm an animated run of algo really performs: Radix Sort animates
+// strings through Intro Sort
+static int sort_animated_algo(const Array *array, int algo) {
+  return algo == 5 && array->type == DATA_STRING ? 4 : algo;
+}
+
+static uint64_t sort_array_run(AppData *app, Array *array, int algo) {
   if (!array || array->size == 0)
     return 0;
+  int shown = sort_is_animated(app) ? sort_animated_algo(array, algo) : algo;
+  set_pseudo_code(app, sort_pseudo_codes[shown]);
   uint64_t start = get_nanoseconds();
+  if (!sort_is_animated(app) &&
+      sort_array_typed(array, algo, app ? app->sort_threads : 0)) {
+    return get_nanoseconds() - start;
+  }
   if (algo == 0) {
-    if (!app->is_benchmarking)
-      set_pseudo_code(app, "BUBBLE_SORT(Tableau A):\n"
-                           "  N = Taille(A)\n"
-                           "  Pour i de 0 \xC3\xA0 N-1 faire:\n"
-                           "    Echange = Faux\n"
-                           "    Pour j de 0 \xC3\xA0 N-i-1 faire:\n"
-                           "      Si A[j] > A[j+1] alors:\n"
-                           "        Echanger(A[j], A[j+1])\n"
-                           "        Echange = Vrai\n"
-                           "      Fin Si\n"
-                           "    Fin Pour\n"
-                           "    Si Echange == Faux alors: STOP\n"
-                           "  Fin Pour");
     bubble_sort(app, array->data, array->size, array->element_size,
                 array->compare_func);
   } else if (algo == 1) {
-    if (!app->is_benchmarking)
-      set_pseudo_code(app, "INSERTION_SORT(Tableau A):\n"
-                           "  N = Taille(A)\n"
-                           "  Pour i de 1 \xC3\xA0 N-1 faire:\n"
-                           "    cle = A[i]\n"
-                           "    j = i - 1\n"
-                           "    Tant que j >= 0 et A[j] > cle faire:\n"
-                           "      A[j+1] = A[j]\n"
-                           "      j = j - 1\n"
-                           "    Fin Tant que\n"
-                           "    A[j+1] = cle\n"
-                           "  Fin Pour");
     insertion_sort(app, array->data, array->size, array->element_size,
                    array->compare_func);
   } else if (algo == 2) {
-    if (!app->is_benchmarking)
-      set_pseudo_code(
-          app, "SHELL_SORT(Tableau A):\n"
-               "  N = Taille(A)\n"
-               "  Pour ecart de N/2 \xC3\xA0 0 faire:\n"
-               "    Pour i de ecart \xC3\xA0 N-1 faire:\n"
-               "      temp = A[i]\n"
-               "      Pour j de i \xC3\xA0 ecart et A[j-ecart] > temp faire:\n"
-               "        A[j] = A[j-ecart]\n"
-               "      Fin Pour\n"
-               "      A[j] = temp\n"
-               "    Fin Pour\n"
-               "  Fin Pour");
     shell_sort(app, array->data, array->size, array->element_size,
                array->compare_func);
   } else if (algo == 3 && array->size > 0) {
-    if (!app->is_benchmarking)
-      set_pseudo_code(app, "QUICK_SORT(A, bas, haut):\n"
-                           "  Si bas < haut alors:\n"
-                           "    p = Partition(A, bas, haut)\n"
-                           "    QUICK_SORT(A, bas, p - 1)\n"
-                           "    QUICK_SORT(A, p + 1, haut)\n"
-                           "  Fin Si\n\n"
-                           "PARTITION(A, bas, haut):\n"
-                           "  pivot = A[haut]\n"
-                           "  i = bas\n"
-                           "  Pour j de bas \xC3\xA0 haut-1 faire:\n"
-                           "    Si A[j] <= pivot alors:\n"
-                           "      Echanger(A[i], A[j])\n"
-                           "      i = i + 1\n"
-                           "    Fin Si\n"
-                           "  Fin Pour\n"
-                           "  Echanger(A[i], A[haut])\n"
-                           "  Retourner i");
     qs_rec(app, array->data, 0, array->size - 1, array->element_size,
            array->compare_func);
+  } else if (algo == 4) {
+    intro_sort_generic(app, array->data, array->size, array->element_size,
+                       array->compare_func, intro_depth_limit(array->size));
+  } else if (algo == 5) {
+    radix_sort_array(app, array);
+  } else if (algo == 6) {
+    char *tmp = malloc(array->size * array->element_size);
+    STAT_ALLOC(1);
+    merge_sort_generic(app, array->data, tmp, array->size,
+                       array->element_size, array->compare_func);
+    free(tmp);
+  } else if (algo == 7) {
+    tim_sort_generic(app, array->data, array->size, array->element_size,
+                     array->compare_func);
   }
   return get_nanoseconds() - start;
 }
 
+// Returns the time taken; stats (may be NULL) receives the operation counts,
+// all zero when they are compiled out.
+uint64_t sort_array_wrapper(AppData *app, Array *array, int algo,
+                            SortStats *stats) {
+  PROF_SCOPE("sort_array");
+#ifdef SORT_STATS
+  memset(&sort_stats_tls, 0, sizeof(sort_stats_tls));
+#endif
+  uint64_t t = sort_array_run(app, array, algo);
+  if (stats) {
+#ifdef SORT_STATS
+    *stats = sort_stats_tls;
+#else
+    memset(stats, 0, sizeof(*stats));
+#endif
+  }
+  return t;
+}
+
+// --- Operation traces: recording and files ---
+
+// Sorts array with algo through the hooked generic sorts and returns the
+// trace of the run. The array ends up sorted as with sort_array_wrapper.
+static SortTrace *sort_trace_record(AppData *app, Array *array, int algo,
+                                    SortStats *stats) {
+  SortTrace *tr = g_new0(SortTrace, 1);
+  size_t n = array->size;
+  tr->type = array->type;
+  tr->algo = sort_animated_algo(array, algo); // Titles the replay
+  tr->n = n;
+  tr->initial = g_new(uint32_t, n);
+
+  TraceRecorder rec = {0};
+  rec.trace = tr;
+  rec.base = array->data;
+  rec.es = array->element_size;
+  rec.cmp = array->compare_func;
+  rec.line = -1;
+  if (array->type == DATA_STRING) {
+    char **strs = array->data;
+    tr->strings = g_new(char *, n);
+    rec.ids = g_hash_table_new(g_direct_hash, g_direct_equal);
+    for (size_t i = 0; i < n; i++) {
+      tr->strings[i] = g_strdup(strs[i]);
+      g_hash_table_insert(rec.ids, strs[i], GUINT_TO_POINTER(i + 1));
+    }
+  }
+  for (size_t i = 0; i < n; i++)
+    tr->initial[i] = trace_encode(&rec, rec.base + i * rec.es);
+  rec.shadow = g_new(uint32_t, n);
+  memcpy(rec.shadow, tr->initial, n * sizeof(uint32_t));
+
+  array->compare_func = trace_compare;
+  g_private_set(&trace_recorder_key, &rec);
+  tr->elapsed = sort_array_wrapper(app, array, algo, stats);
+  g_private_set(&trace_recorder_key, NULL);
+  array->compare_func = rec.cmp;
+  trace_record_sync(&rec);
+  tr->events = g_renew(TraceEvent, tr->events, tr->count);
+  tr->capacity = tr->count;
+
+  g_free(rec.shadow);
+  if (rec.ids)
+    g_hash_table_destroy(rec.ids);
+  if (!tr->code)
+    tr->code = g_strdup("");
+  return tr;
+}
+
+static void sort_trace_free(SortTrace *tr) {
+  if (!tr)
+    return;
+  if (tr->strings) {
+    for (uint32_t i = 0; i < tr->n; i++)
+      g_free(tr->strings[i]);
+    g_free(tr->strings);
+  }
+  g_free(tr->initial);
+  g_free(tr->code);
+  g_free(tr->events);
+  g_free(tr);
+}
+
+// File layout (host byte order): TraceFileHeader, the pseudo-code, the n
+// initial codes, for strings n records (uint32 length + bytes, UINT32_MAX
+// for NULL), then the events.
+typedef struct {
+  char magic[8];
+  uint32_t type;
+  uint32_t algo;
+  uint32_t n;
+  uint32_t code_len;
+  uint64_t count;
+  uint64_t elapsed;
+  uint32_t flags; // Bit 0: truncated
+  uint32_t reserved;
+} TraceFileHeader;
+
+static gboolean sort_trace_save(const SortTrace *tr, const char *filename) {
+  FILE *f = fopen(filename, "wb");
+  if (!f)
+    return FALSE;
+  TraceFileHeader h = {0};
+  memcpy(h.magic, TRACE_MAGIC, sizeof(h.magic));
+  h.type = tr->type;
+  h.algo = tr->algo;
+  h.n = tr->n;
+  h.code_len = strlen(tr->code);
+  h.count = tr->count;
+  h.elapsed = tr->elapsed;
+  h.flags = tr->truncated ? 1 : 0;
+
+  gboolean ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+                fwrite(tr->code, 1, h.code_len, f) == h.code_len &&
+                fwrite(tr->initial, sizeof(uint32_t), tr->n, f) == tr->n;
+  for (uint32_t i = 0; ok && tr->strings && i < tr->n; i++) {
+    uint32_t len = tr->strings[i] ? strlen(tr->strings[i]) : UINT32_MAX;
+    ok = fwrite(&len, sizeof(len), 1, f) == 1 &&
+         (len == UINT32_MAX || fwrite(tr->strings[i], 1, len, f) == len);
+  }
+  ok = ok && fwrite(tr->events, sizeof(TraceEvent), tr->count, f) == tr->count;
+  return fclose(f) == 0 && ok;
+}
+
+// Checks that replaying ev cannot index past the array
+static gboolean trace_event_valid(const SortTrace *tr, const TraceEvent *ev) {
+  switch (ev->op) {
+  case TRACE_LINE:
+    return TRUE;
+  case TRACE_COMPARE:
+    return (ev->i < tr->n || ev->i == TRACE_NONE) &&
+           (ev->a < tr->n || ev->a == TRACE_NONE);
+  case TRACE_SWAP:
+    return ev->i < tr->n && ev->a < tr->n;
+  case TRACE_WRITE:
+    return ev->i < tr->n &&
+           (tr->type != DATA_STRING || (ev->a < tr->n && ev->b < tr->n));
+  }
+  return FALSE;
+}
+
+static gboolean sort_trace_read_body(FILE *f, const TraceFileHeader *h,
+                                     SortTrace *tr) {
+  tr->code = g_malloc0(h->code_len + 1);
+  if (fread(tr->code, 1, h->code_len, f) != h->code_len)
+    return FALSE;
+  tr->initial = g_try_new(uint32_t, tr->n);
+  if (tr->n && (!tr->initial ||
+                fread(tr->initial, sizeof(uint32_t), tr->n, f) != tr->n))
+    return FALSE;
+  if (tr->type == DATA_STRING) {
+    tr->strings = g_new0(char *, tr->n);
+    for (uint32_t i = 0; i < tr->n; i++) {
+      uint32_t len;
+      if (fread(&len, sizeof(len), 1, f) != 1)
+        return FALSE;
+      if (len == UINT32_MAX)
+        continue;
+      if (len > (1u << 20))
+        return FALSE;
+      tr->strings[i] = g_malloc(len + 1);
+      tr->strings[i][len] = '\0';
+      if (fread(tr->strings[i], 1, len, f) != len)
+        return FALSE;
+    }
+    for (uint32_t i = 0; i < tr->n; i++)
+      if (tr->initial[i] >= tr->n)
+        return FALSE;
+  }
+  tr->count = tr->capacity = h->count;
+  tr->events = g_try_new(TraceEvent, tr->count);
+  if (tr->count && (!tr->events || fread(tr->events, sizeof(TraceEvent),
+                                         tr->count, f) != tr->count))
+    return FALSE;
+  for (size_t k = 0; k < tr->count; k++)
+    if (!trace_event_valid(tr, &tr->events[k]))
+      return FALSE;
+  return TRUE;
+}
+
+// Returns NULL when the file is unreadable or not a valid trace.
+static SortTrace *sort_trace_load(const char *filename) {
+  FILE *f = fopen(filename, "rb");
+  if (!f)
+    return NULL;
+  TraceFileHeader h;
+  if (fread(&h, sizeof(h), 1, f) != 1 ||
+      memcmp(h.magic, TRACE_MAGIC, sizeof(h.magic)) != 0 ||
+      h.type > DATA_STRING || h.algo >= NUM_SORT_ALGOS ||
+      h.count > (uint64_t)TRACE_MAX_EVENTS + h.n || h.code_len > (1u << 20)) {
+    fclose(f);
+    return NULL;
+  }
+  SortTrace *tr = g_new0(SortTrace, 1);
+  tr->type = h.type;
+  tr->algo = h.algo;
+  tr->n = h.n;
+  tr->elapsed = h.elapsed;
+  tr->truncated = (h.flags & 1) != 0;
+  gboolean ok = sort_trace_read_body(f, &h, tr);
+  fclose(f);
+  if (!ok) {
+    sort_trace_free(tr);
+    return NULL;
+  }
+  return tr;
+}
+
 // =============================================================================
 //                             LISTES CHAÎNÉES
 // =============================================================================
 
-void free_node(Node *node, DataType type) {
-  if (!node)
-    return;
-  if (type == DATA_STRING && node->data)
-    g_free(*(char **)node->data);
-  if (node->data)
-    free(node->data);
-  g_free(node);
-}
-
-Node *create_node(DataType type, const void *value) {
-  Node *node = g_new0(Node, 1);
-  size_t size = get_element_size(type);
-  node->data = malloc(size);
-  if (value) {
-    if (type == DATA_STRING)
-      *((char **)node->data) = g_strdup(*(const char **)value);
-    else
-      memcpy(node->data, value, size);
-  }
+// Returns an unlinked node to its list's pool; its string stays in the arena
+void free_node(LinkedList *list, Node *node) {
+  if (node)
+    node_pool_release(list->nodes, node);
+}
+
+// A node for list holding a copy of *value (a string in the list's arena),
+// zeroed when value is NULL; it is not linked
+Node *create_node(LinkedList *list, const void *value) {
+  Node *node = node_pool_alloc(list->nodes);
+  if (value)
+    mem_store_value(MEM_LIST, list->type, list->strings, node->data, value);
   return node;
 }
 
-LinkedList *create_linked_list(DataType type, gboolean is_doubly_linked) {
-  LinkedList *list = g_new0(LinkedList, 1);
+static size_t skip_node_size(int height) {
+  return sizeof(SkipNode) + height * sizeof(SkipLink);
+}
+
+// An empty list of kind: simple, double, unrolled or skip list
+LinkedList *create_list(DataType type, StructureType kind) {
+  LinkedList *list = mem_alloc0(MEM_LIST, sizeof(LinkedList));
   list->type = type;
-  list->is_doubly_linked = is_doubly_linked;
+  list->kind = kind;
+  list->is_doubly_linked = kind == STRUCTURE_DOUBLE_LIST;
+  if (kind == STRUCTURE_UNROLLED_LIST) {
+    list->block_cap = LIST_BLOCK_BYTES / get_element_size(type);
+    list->nodes = node_pool_new(
+        MEM_LIST, sizeof(ListBlock) + LIST_BLOCK_BYTES, FALSE);
+  } else if (kind == STRUCTURE_SKIP_LIST) {
+    list->nodes = node_pool_new(MEM_LIST, skip_node_size(1), TRUE);
+    list->skip_pools =
+        mem_alloc0(MEM_LIST, SKIP_MAX_LEVEL * sizeof(NodePool *));
+    list->skip_pools[0] = list->nodes;
+    list->skip_head = mem_alloc0(MEM_LIST, skip_node_size(SKIP_MAX_LEVEL));
+    list->skip_head->height = SKIP_MAX_LEVEL;
+    list->skip_head->links[0].width = 1;
+    list->skip_level = 1;
+    rng_seed(&list->skip_rng, 1); // Heights only: same shapes every run
+  } else {
+    list->nodes = node_pool_new(MEM_LIST, sizeof(Node), TRUE);
+  }
+  if (type == DATA_STRING)
+    list->strings = str_arena_new(MEM_LIST, FALSE);
   return list;
 }
 
+LinkedList *create_linked_list(DataType type, gboolean is_doubly_linked) {
+  return create_list(type, is_doubly_linked ? STRUCTURE_DOUBLE_LIST
+                                            : STRUCTURE_SIMPLE_LIST);
+}
+
+// Empties list, releasing its nodes together
+static void clear_linked_list(LinkedList *list) {
+  if (list->kind == STRUCTURE_UNROLLED_LIST)
+    mem_count_elements(MEM_LIST, -(int64_t)list->size);
+  node_pool_clear(list->nodes);
+  list->head = list->tail = NULL;
+  list->first = list->last = NULL;
+  if (list->skip_head) {
+    for (int h = 1; h < SKIP_MAX_LEVEL; h++)
+      if (list->skip_pools[h])
+        node_pool_clear(list->skip_pools[h]);
+    list->skip_head->links[0] = (SkipLink){NULL, 1};
+    list->skip_level = 1;
+  }
+  list->size = 0;
+}
+
 void free_linked_list(LinkedList *list) {
   if (!list)
     return;
-  Node *cur = list->head;
-  while (cur) {
-    Node *next = cur->next;
-    free_node(cur, list->type);
-    cur = next;
+  clear_linked_list(list);
+  if (list->skip_head) {
+    for (int h = 1; h < SKIP_MAX_LEVEL; h++)
+      node_pool_free(list->skip_pools[h]);
+    mem_free(MEM_LIST, list->skip_pools,
+             SKIP_MAX_LEVEL * sizeof(NodePool *));
+    mem_free(MEM_LIST, list->skip_head, skip_node_size(SKIP_MAX_LEVEL));
+  }
+  node_pool_free(list->nodes);
+  str_arena_unref(list->strings);
+  mem_free(MEM_LIST, list, sizeof(LinkedList));
+}
+
+// Appends n zeroed nodes, contiguous in memory, and returns the first
+static Node *list_append_block(LinkedList *list, size_t n) {
+  if (n == 0)
+    return NULL;
+  Node *first = node_pool_alloc_run(list->nodes, n);
+  for (size_t i = 0; i + 1 < n; i++)
+    first[i].next = &first[i + 1];
+  if (list->is_doubly_linked)
+    for (size_t i = 1; i < n; i++)
+      first[i].prev = &first[i - 1];
+  if (list->tail)
+    list->tail->next = first;
+  else
+    list->head = first;
+  if (list->is_doubly_linked)
+    first->prev = list->tail;
+  list->tail = &first[n - 1];
+  list->size += n;
+  return first;
+}
+
+// --- Unrolled lists ---
+// An unrolled list keeps its values in a doubly linked chain of blocks of
+// LIST_BLOCK_BYTES, each with its count. A position is found by skipping
+// whole blocks, from the nearer end, and a traversal reads values side by
+// side, so both follow one pointer per block instead of one per value.
+// Blocks come from the list's pool and are never left empty. A full block
+// is split in two on insertion, except at its ends where a fresh block is
+// started; after a deletion, a block less than half full takes in its
+// successor when they fit together.
+
+// Links a new zeroed block after the given one, or first when it is NULL
+static ListBlock *unrolled_new_block(LinkedList *list, ListBlock *after) {
+  ListBlock *b = node_pool_alloc(list->nodes);
+  b->prev = after;
+  b->next = after ? after->next : list->first;
+  if (b->next)
+    b->next->prev = b;
+  else
+    list->last = b;
+  if (after)
+    after->next = b;
+  else
+    list->first = b;
+  return b;
+}
+
+static void unrolled_drop_block(LinkedList *list, ListBlock *b) {
+  if (b->prev)
+    b->prev->next = b->next;
+  else
+    list->first = b->next;
+  if (b->next)
+    b->next->prev = b->prev;
+  else
+    list->last = b->prev;
+  node_pool_release(list->nodes, b);
+}
+
+// Block holding position *pos, which becomes the index in that block;
+// position size is the end of the last block. The list is not empty.
+static ListBlock *unrolled_find(const LinkedList *list, size_t *pos) {
+  ListBlock *b;
+  if (*pos <= list->size / 2) {
+    b = list->first;
+    while (*pos >= b->count && b->next) {
+      *pos -= b->count;
+      b = b->next;
+    }
+  } else {
+    size_t back = list->size - *pos; // Values from pos to the end
+    b = list->last;
+    while (back > b->count) {
+      back -= b->count;
+      b = b->prev;
+    }
+    *pos = b->count - back;
+  }
+  return b;
+}
+
+// Opens a zeroed slot at position pos (at most size) and returns it
+static void *unrolled_insert_slot(LinkedList *list, size_t pos) {
+  size_t es = get_element_size(list->type);
+  ListBlock *b = list->first ? unrolled_find(list, &pos)
+                             : unrolled_new_block(list, NULL);
+  if (b->count == list->block_cap) {
+    if (pos == b->count) {
+      b = unrolled_new_block(list, b);
+      pos = 0;
+    } else if (pos == 0) {
+      b = unrolled_new_block(list, b->prev);
+    } else {
+      // Split: the upper half moves to a new block after b
+      ListBlock *nb = unrolled_new_block(list, b);
+      size_t half = b->count / 2;
+      nb->count = b->count - half;
+      memcpy(nb->data, b->data + half * es, nb->count * es);
+      b->count = half;
+      if (pos > half) {
+        pos -= half;
+        b = nb;
+      }
+    }
   }
-  g_free(list);
+  char *slot = b->data + pos * es;
+  memmove(slot + es, slot, (b->count - pos) * es);
+  memset(slot, 0, es);
+  b->count++;
+  list->size++;
+  mem_count_elements(MEM_LIST, 1);
+  return slot;
+}
+
+static void unrolled_delete(LinkedList *list, size_t pos) {
+  size_t es = get_element_size(list->type);
+  ListBlock *b = unrolled_find(list, &pos);
+  char *slot = b->data + pos * es;
+  memmove(slot, slot + es, (b->count - pos - 1) * es);
+  b->count--;
+  list->size--;
+  mem_count_elements(MEM_LIST, -1);
+  ListBlock *next = b->next;
+  if (b->count == 0) {
+    unrolled_drop_block(list, b);
+  } else if (next && b->count < list->block_cap / 2 &&
+             b->count + next->count <= list->block_cap) {
+    memcpy(b->data + b->count * es, next->data, next->count * es);
+    b->count += next->count;
+    unrolled_drop_block(list, next);
+  }
+}
+
+// Appends n zeroed values: the last block is topped up, then full blocks
+// are carved from the pool in one run
+static void unrolled_append_zeroed(LinkedList *list, size_t n) {
+  size_t es = get_element_size(list->type), cap = list->block_cap;
+  mem_count_elements(MEM_LIST, (int64_t)n);
+  list->size += n;
+  if (list->last) {
+    ListBlock *last = list->last;
+    size_t k = MIN(n, cap - last->count);
+    memset(last->data + last->count * es, 0, k * es);
+    last->count += k;
+    n -= k;
+  }
+  size_t blocks = (n + cap - 1) / cap;
+  if (blocks == 0)
+    return;
+  char *run = node_pool_alloc_run(list->nodes, blocks);
+  for (size_t i = 0; i < blocks; i++) {
+    ListBlock *b = (ListBlock *)(run + i * list->nodes->node_size);
+    b->count = MIN(cap, n - i * cap);
+    b->prev = list->last;
+    if (list->last)
+      list->last->next = b;
+    else
+      list->first = b;
+    list->last = b;
+  }
+}
+
+// --- Skip lists ---
+// A skip list threads its nodes on several levels: every node is on level
+// 0, and one in four of the nodes on a level also reaches the next one.
+// Each link records its width, the number of positions it jumps, so a
+// position is reached from the top level down by adding up widths, in
+// O(log n) steps on average, and an insertion or deletion only rewrites
+// the links passing over it. Heights are drawn from the list's own
+// generator and nodes come from one pool per height.
+
+// 1, plus one level with probability 1/4 each time
+static int skip_random_height(LinkedList *list) {
+  uint64_t r = rng_next(&list->skip_rng);
+  int h = 1;
+  while (h < SKIP_MAX_LEVEL && (r & 3) == 0) {
+    h++;
+    r >>= 2;
+  }
+  return h;
+}
+
+// A zeroed node of random height
+static SkipNode *skip_new_node(LinkedList *list) {
+  int h = skip_random_height(list);
+  if (!list->skip_pools[h - 1])
+    list->skip_pools[h - 1] =
+        node_pool_new(MEM_LIST, skip_node_size(h), TRUE);
+  SkipNode *n = node_pool_alloc(list->skip_pools[h - 1]);
+  n->height = h;
+  return n;
+}
+
+// Node at position pos (NULL at the end). When update is given, update[i]
+// is the last node before pos on level i and rank[i] its position plus one,
+// 0 for the sentinel.
+static SkipNode *skip_locate(const LinkedList *list, size_t pos,
+                             SkipNode **update, size_t *rank) {
+  SkipNode *x = list->skip_head;
+  size_t r = 0;
+  for (int i = list->skip_level - 1; i >= 0; i--) {
+    while (x->links[i].next && r + x->links[i].width <= pos) {
+      r += x->links[i].width;
+      x = x->links[i].next;
+    }
+    if (update) {
+      update[i] = x;
+      rank[i] = r;
+    }
+  }
+  return x->links[0].next;
+}
+
+// Links n at position pos, from update and rank as skip_locate() left them
+static void skip_link(LinkedList *list, SkipNode *n, size_t pos,
+                      SkipNode **update, size_t *rank) {
+  for (int i = list->skip_level; i < n->height; i++) {
+    update[i] = list->skip_head; // New level: the sentinel to the end
+    rank[i] = 0;
+    list->skip_head->links[i] = (SkipLink){NULL, list->size + 1};
+  }
+  list->skip_level = MAX(list->skip_level, n->height);
+  for (int i = 0; i < list->skip_level; i++) {
+    SkipLink *l = &update[i]->links[i];
+    if (i < n->height) {
+      n->links[i].next = l->next;
+      n->links[i].width = l->width - (pos - rank[i]);
+      l->next = n;
+      l->width = pos + 1 - rank[i];
+    } else {
+      l->width++; // Passes over n
+    }
+  }
+  list->size++;
+}
+
+// Opens a zeroed slot at position pos (at most size) and returns it
+static void *skip_insert_slot(LinkedList *list, size_t pos) {
+  SkipNode *update[SKIP_MAX_LEVEL];
+  size_t rank[SKIP_MAX_LEVEL];
+  skip_locate(list, pos, update, rank);
+  SkipNode *n = skip_new_node(list);
+  skip_link(list, n, pos, update, rank);
+  return n->data;
+}
+
+static void skip_delete(LinkedList *list, size_t pos) {
+  SkipNode *update[SKIP_MAX_LEVEL];
+  size_t rank[SKIP_MAX_LEVEL];
+  SkipNode *del = skip_locate(list, pos, update, rank);
+  for (int i = 0; i < list->skip_level; i++) {
+    SkipLink *l = &update[i]->links[i];
+    if (l->next == del) {
+      l->width += del->links[i].width - 1;
+      l->next = del->links[i].next;
+    } else {
+      l->width--;
+    }
+  }
+  while (list->skip_level > 1 &&
+         !list->skip_head->links[list->skip_level - 1].next)
+    list->skip_level--;
+  node_pool_release(list->skip_pools[del->height - 1], del);
+  list->size--;
+}
+
+// Appends n zeroed values in O(n): the last node of every level is kept
+// as the next predecessor
+static void skip_append_zeroed(LinkedList *list, size_t n) {
+  SkipNode *update[SKIP_MAX_LEVEL];
+  size_t rank[SKIP_MAX_LEVEL];
+  skip_locate(list, list->size, update, rank);
+  for (size_t k = 0; k < n; k++) {
+    SkipNode *node = skip_new_node(list);
+    size_t pos = list->size;
+    skip_link(list, node, pos, update, rank);
+    for (int i = 0; i < node->height; i++) {
+      update[i] = node;
+      rank[i] = pos + 1;
+    }
+  }
+}
+
+// Cursor over the values of a list of any kind
+typedef struct {
+  Node *node;
+  SkipNode *skip;
+  ListBlock *block;
+  size_t index; // In block
+  size_t es;
+} ListIter;
+
+// First value of list, or NULL when empty
+static void *list_iter_begin(const LinkedList *list, ListIter *it) {
+  memset(it, 0, sizeof(*it));
+  it->es = get_element_size(list->type);
+  switch (list->kind) {
+  case STRUCTURE_UNROLLED_LIST:
+    it->block = list->first;
+    return it->block ? it->block->data : NULL;
+  case STRUCTURE_SKIP_LIST:
+    it->skip = list->skip_head->links[0].next;
+    return it->skip ? it->skip->data : NULL;
+  default:
+    it->node = list->head;
+    return it->node ? it->node->data : NULL;
+  }
+}
+
+// Next value, or NULL past the end
+static void *list_iter_next(ListIter *it) {
+  if (it->node) {
+    it->node = it->node->next;
+    return it->node ? it->node->data : NULL;
+  }
+  if (it->skip) {
+    it->skip = it->skip->links[0].next;
+    return it->skip ? it->skip->data : NULL;
+  }
+  if (!it->block)
+    return NULL;
+  if (++it->index == it->block->count) {
+    it->block = it->block->next;
+    it->index = 0;
+    if (!it->block)
+      return NULL;
+  }
+  return it->block->data + it->index * it->es;
+}
+
+// Appends n zeroed values to a list of any kind
+static void list_append_zeroed(LinkedList *list, size_t n) {
+  if (list->kind == STRUCTURE_UNROLLED_LIST)
+    unrolled_append_zeroed(list, n);
+  else if (list->kind == STRUCTURE_SKIP_LIST)
+    skip_append_zeroed(list, n);
+  else
+    list_append_block(list, n);
+}
+
+// Value cell at position, which must exist
+static void *list_value_at(const LinkedList *list, size_t position) {
+  if (list->kind == STRUCTURE_UNROLLED_LIST) {
+    ListBlock *b = unrolled_find(list, &position);
+    return b->data + position * get_element_size(list->type);
+  }
+  if (list->kind == STRUCTURE_SKIP_LIST)
+    return skip_locate(list, position, NULL, NULL)->data;
+  Node *cur = list->head;
+  for (size_t i = 0; i < position; i++)
+    cur = cur->next;
+  return cur->data;
 }
 
 LinkedList *copy_linked_list(const LinkedList *src) {
   if (!src)
     return NULL;
-  LinkedList *copy = create_linked_list(src->type, src->is_doubly_linked);
-  Node *cur = src->head;
-  while (cur) {
-    Node *n = create_node(src->type, cur->data);
-    insert_to_linkedlist(copy, n, -1);
-    cur = cur->next;
+  LinkedList *copy = create_list(src->type, src->kind);
+  // The copy shares the strings
+  str_arena_unref(copy->strings);
+  copy->strings = str_arena_ref(src->strings);
+  list_append_zeroed(copy, src->size);
+  if (src->kind == STRUCTURE_SKIP_LIST) {
+    ListIter from, to;
+    void *v = list_iter_begin(src, &from);
+    for (void *d = list_iter_begin(copy, &to); d; d = list_iter_next(&to)) {
+      memcpy(d, v, NODE_VALUE_SIZE);
+      v = list_iter_next(&from);
+    }
+    return copy;
+  }
+  if (src->kind == STRUCTURE_UNROLLED_LIST) {
+    // Whole blocks at a time: the copy is packed full
+    size_t es = get_element_size(src->type), at = 0;
+    ListBlock *dst = copy->first;
+    for (const ListBlock *b = src->first; b; b = b->next)
+      for (size_t done = 0; done < b->count;) {
+        size_t k = MIN(b->count - done, dst->count - at);
+        memcpy(dst->data + at * es, b->data + done * es, k * es);
+        done += k;
+        at += k;
+        if (at == dst->count) {
+          dst = dst->next;
+          at = 0;
+        }
+      }
+    return copy;
   }
+  Node *dst = copy->head;
+  for (const Node *cur = src->head; cur; cur = cur->next, dst = dst->next)
+    memcpy(dst->data, cur->data, NODE_VALUE_SIZE);
   return copy;
 }
 
@@ -1079,10 +4640,34 @@ void insert_to_linkedlist(LinkedList *list, Node *new_node, int position) {
   list->size++;
 }
 
+// Inserts a copy of value into a list of any kind, at position or at the
+// end when position is out of range
+void list_insert_value(LinkedList *list, const void *value, int position) {
+  if (list->kind != STRUCTURE_UNROLLED_LIST &&
+      list->kind != STRUCTURE_SKIP_LIST) {
+    insert_to_linkedlist(list, create_node(list, value), position);
+    return;
+  }
+  if (position < 0 || (size_t)position > list->size)
+    position = (int)list->size;
+  void *cell = list->kind == STRUCTURE_SKIP_LIST
+                   ? skip_insert_slot(list, (size_t)position)
+                   : unrolled_insert_slot(list, (size_t)position);
+  mem_store_value(MEM_LIST, list->type, list->strings, cell, value);
+}
+
 gboolean delete_from_linkedlist(LinkedList *list, int position) {
   if (!list || list->size == 0 || position < 0 ||
       (size_t)position >= list->size)
     return FALSE;
+  if (list->kind == STRUCTURE_UNROLLED_LIST) {
+    unrolled_delete(list, (size_t)position);
+    return TRUE;
+  }
+  if (list->kind == STRUCTURE_SKIP_LIST) {
+    skip_delete(list, (size_t)position);
+    return TRUE;
+  }
   Node *del = NULL;
   if (position == 0) {
     del = list->head;
@@ -1092,18 +4677,18 @@ gboolean delete_from_linkedlist(LinkedList *list, int position) {
     else if (!list->head)
       list->tail = NULL;
   } else {
-    Node *cur = list->head;
-    for (int i = 0; i < position; i++)
-      cur = cur->next;
-    del = cur;
-    if (del->prev)
-      del->prev->next = del->next;
+    // Walk to the predecessor: singly linked nodes have no prev
+    Node *prev = list->head;
+    for (int i = 0; i < position - 1; i++)
+      prev = prev->next;
+    del = prev->next;
+    prev->next = del->next;
     if (del->next && list->is_doubly_linked)
-      del->next->prev = del->prev;
+      del->next->prev = prev;
     if (del == list->tail)
-      list->tail = del->prev;
+      list->tail = prev;
   }
-  free_node(del, list->type);
+  free_node(list, del);
   list->size--;
   return TRUE;
 }
@@ -1113,52 +4698,60 @@ gboolean modify_linkedlist(LinkedList *list, int position,
   if (!list || list->size == 0 || position < 0 ||
       (size_t)position >= list->size)
     return FALSE;
-  Node *cur = list->head;
-  for (int i = 0; i < position; i++)
-    cur = cur->next;
-
-  void *nd = malloc(get_element_size(list->type));
+  // The old string stays in the arena
+  void *nd = list_value_at(list, (size_t)position);
   if (list->type == DATA_INT)
     *(int *)nd = atoi(val_str);
   else if (list->type == DATA_FLOAT)
     *(float *)nd = atof(val_str);
   else if (list->type == DATA_CHAR)
     *(char *)nd = val_str[0];
-  else if (list->type == DATA_STRING) {
-    if (cur->data)
-      g_free(*(char **)cur->data);
-    *(char **)nd = g_strdup(val_str);
-  }
-  if (list->type != DATA_STRING && cur->data)
-    free(cur->data);
-  cur->data = nd;
+  else if (list->type == DATA_STRING)
+    *(char **)nd = str_new(MEM_LIST, list->strings, val_str);
   return TRUE;
 }
 
-void fill_linked_list_random(LinkedList *list, size_t size) {
-  while (list->head)
-    delete_from_linkedlist(list, 0);
-  srand(time(NULL));
-  for (size_t i = 0; i < size; i++) {
-    Node *n = create_node(list->type, NULL);
-    // Manually fill cause create_node copies value
-    void *ptr = n->data;
-    switch (list->type) {
-    case DATA_INT:
-      *(int *)ptr = rand() % 1000;
-      break;
-    case DATA_FLOAT:
-      *(float *)ptr = (float)rand() / (RAND_MAX / 100.0);
-      break;
-    case DATA_CHAR:
-      *(char *)ptr = (char)(33 + rand() % 94);
-      break;
-    case DATA_STRING: {
-      *((char **)ptr) = generate_random_string();
-    } break;
+void fill_linked_list_random(LinkedList *list, size_t size, Rng *rng) {
+  fill_linked_list_dist(list, size, DIST_RANDOM, rng);
+}
+
+void fill_linked_list_dist(LinkedList *list, size_t size, Distribution dist,
+                           Rng *rng) {
+  PROF_SCOPE("fill_linked_list_dist");
+  clear_linked_list(list);
+  str_arena_clear(list->strings);
+  str_arena_set_interning(list->strings, dist_repeats_values(dist));
+  DistGenerator gen = dist_generators[dist];
+  double *u = NULL;
+  if (gen) {
+    u = g_new(double, MAX(size, 1));
+    gen(u, size, rng);
+  }
+  list_append_zeroed(list, size);
+  ListIter it;
+  void *ptr = list_iter_begin(list, &it);
+  for (size_t i = 0; i < size; i++, ptr = list_iter_next(&it)) {
+    if (u) {
+      store_dist_value(ptr, list->type, MEM_LIST, list->strings, u[i], 1000,
+                       100.0f);
+    } else {
+      switch (list->type) {
+      case DATA_INT:
+        *(int *)ptr = (int)rng_below(rng, 1000);
+        break;
+      case DATA_FLOAT:
+        *(float *)ptr = (float)(rng_double(rng) * 100.0);
+        break;
+      case DATA_CHAR:
+        *(char *)ptr = (char)(33 + rng_below(rng, 94));
+        break;
+      case DATA_STRING: {
+        *((char **)ptr) = generate_random_string(MEM_LIST, list->strings, rng);
+      } break;
+      }
     }
-    insert_to_linkedlist(list, n, -1);
   }
+  g_free(u);
 }
 
 char *list_to_string(const LinkedList *list, gboolean styled) {
@@ -1171,21 +4764,22 @@ char *list_to_string(const LinkedList *list, gboolean styled) {
     styled = FALSE;
   }
 
-  Node *cur = list->head;
-  while (cur) {
+  ListIter it;
+  size_t left = list->size;
+  for (void *v = list_iter_begin(list, &it); v; v = list_iter_next(&it)) {
     char b[128];
     switch (list->type) {
     case DATA_INT:
-      snprintf(b, 128, "%d", *(int *)cur->data);
+      snprintf(b, 128, "%d", *(int *)v);
       break;
     case DATA_FLOAT:
-      snprintf(b, 128, "%.2f", *(float *)cur->data);
+      snprintf(b, 128, "%.2f", *(float *)v);
       break;
     case DATA_CHAR:
-      snprintf(b, 128, "%c", *(char *)cur->data);
+      snprintf(b, 128, "%c", *(char *)v);
       break;
     case DATA_STRING:
-      snprintf(b, 128, "%s", *(char **)cur->data);
+      snprintf(b, 128, "%s", *(char **)v);
       break;
     }
     if (styled)
@@ -1193,40 +4787,144 @@ char *list_to_string(const LinkedList *list, gboolean styled) {
                              ACCENT_PRIMARY, b);
     else
       g_string_append_printf(str, "%s ", b);
-    if (cur->next)
+    if (--left)
       g_string_append(str, "-> ");
-    cur = cur->next;
   }
   return g_string_free(str, FALSE);
 }
 
-uint64_t sort_list_wrapper(AppData *app, LinkedList *list, int algo) {
-  if (!list || list->size == 0)
-    return 0;
-  // Copy to array, sort, copy back
-  Array *arr = create_array(list->type, list->size);
+// Lists are sorted through an array copy of their values; strings stay in
+// the list's arena and only their pointers move
+static Array *list_to_array(const LinkedList *list) {
+  Array *arr = array_new(list->type, list->size, list->strings);
+  ListIter it;
+  void *v = list_iter_begin(list, &it);
+  for (size_t i = 0; i < list->size; i++, v = list_iter_next(&it))
+    memcpy((char *)arr->data + i * arr->element_size, v, arr->element_size);
+  return arr;
+}
+
+// Writes the values back in order and frees arr
+static void array_to_list(Array *arr, LinkedList *list) {
+  ListIter it;
+  void *v = list_iter_begin(list, &it);
+  for (size_t i = 0; i < list->size; i++, v = list_iter_next(&it))
+    memcpy(v, (char *)arr->data + i * arr->element_size, arr->element_size);
+  free_array(arr);
+}
+
+// Merges two sorted runs linked through next; ties take a's node
+static Node *list_merge_runs(Node *a, Node *b,
+                             int (*cmp)(const void *, const void *)) {
+  Node head, *t = &head;
+  while (a && b) {
+    STAT_COMPARE();
+    if (cmp(b->data, a->data) < 0) {
+      t->next = b;
+      b = b->next;
+    } else {
+      t->next = a;
+      a = a->next;
+    }
+    t = t->next;
+  }
+  t->next = a ? a : b;
+  return head.next;
+}
+
+// Stable bottom-up merge sort that relinks the nodes in place. Nodes are
+// taken one at a time and merged like a binary counter: pending[i] holds a
+// sorted run of 2^i nodes, so runs are merged while their nodes are still
+// in cache, and the extra memory is this fixed array of run heads. prev and
+// tail are rebuilt by a last walk.
+static void list_merge_sort(LinkedList *list) {
+  int (*cmp)(const void *, const void *) = get_compare_func(list->type);
+  Node *pending[64] = {NULL};
   Node *cur = list->head;
-  for (size_t i = 0; i < list->size; i++) {
-    void *dest = (char *)arr->data + i * arr->element_size;
-    if (list->type == DATA_STRING)
-      *((char **)dest) = g_strdup(*(char **)cur->data);
-    else
-      memcpy(dest, cur->data, arr->element_size);
+  while (cur) {
+    Node *run = cur;
     cur = cur->next;
+    run->next = NULL;
+    int i = 0;
+    for (; pending[i]; i++) {
+      run = list_merge_runs(pending[i], run, cmp); // pending[i] came first
+      pending[i] = NULL;
+    }
+    pending[i] = run;
+  }
+  Node *sorted = NULL;
+  for (int i = 0; i < 64; i++)
+    if (pending[i])
+      sorted = list_merge_runs(pending[i], sorted, cmp);
+  list->head = sorted;
+  Node *prev = NULL;
+  for (cur = sorted; cur; cur = cur->next) {
+    if (list->is_doubly_linked)
+      cur->prev = prev;
+    prev = cur;
   }
-  uint64_t t = sort_array_wrapper(app, arr, algo);
-  cur = list->head;
-  for (size_t i = 0; i < list->size; i++) {
-    void *src = (char *)arr->data + i * arr->element_size;
-    if (list->type == DATA_STRING) {
-      if (cur->data)
-        g_free(*(char **)cur->data);
-      *(char **)cur->data = g_strdup(*(char **)src);
-    } else
-      memcpy(cur->data, src, arr->element_size);
-    cur = cur->next;
+  list->tail = prev;
+}
+
+// Whether LIST_MERGE_SORT applies to lists of kind: the blocks of an
+// unrolled list and the levels of a skip list are not relinked node by node
+static gboolean list_kind_merge_sortable(StructureType kind) {
+  return kind == STRUCTURE_SIMPLE_LIST || kind == STRUCTURE_DOUBLE_LIST;
+}
+
+// Sorts list with algo: LIST_MERGE_SORT relinks the nodes, the array
+// algorithms go through an array copy of the values and back. The time
+// returned includes both copies. A list merge sort of a kind that is not
+// merge sortable leaves the list as is.
+uint64_t sort_list_wrapper(AppData *app, LinkedList *list, int algo,
+                           SortStats *stats) {
+  PROF_SCOPE("sort_list");
+  if (!list || list->size == 0 ||
+      (algo == LIST_MERGE_SORT && !list_kind_merge_sortable(list->kind))) {
+    if (stats)
+      memset(stats, 0, sizeof(*stats));
+    return 0;
+  }
+  if (algo != LIST_MERGE_SORT) {
+    uint64_t start = get_nanoseconds();
+    Array *arr = list_to_array(list);
+    sort_array_wrapper(app, arr, algo, stats);
+    array_to_list(arr, list);
+    return get_nanoseconds() - start;
+  }
+  if (!app->is_benchmarking)
+    set_pseudo_code(app, "TRI_FUSION_LISTE(L):\n"
+                         "  Attente[0..63] = vides\n"
+                         "  Pour chaque n\xC5\x93ud x de L faire:\n"
+                         "    S\xC3\xA9quence = (x)\n"
+                         "    i = 0\n"
+                         "    Tant que Attente[i] non vide faire:\n"
+                         "      S\xC3\xA9quence = FUSION(Attente[i], "
+                         "S\xC3\xA9quence)\n"
+                         "      Attente[i] = vide ; i = i + 1\n"
+                         "    Fin Tant que\n"
+                         "    Attente[i] = S\xC3\xA9quence "
+                         "(2^i n\xC5\x93uds)\n"
+                         "  Fin Pour\n"
+                         "  FUSION de toutes les Attente[i], "
+                         "de la plus petite \xC3\xA0 la plus grande\n"
+                         "  Relier les pr\xC3\xA9" "c\xC3\xA9" "dents, "
+                         "mettre \xC3\xA0 jour la queue\n\n"
+                         "FUSION(A, B): relie les n\xC5\x93uds "
+                         "(\xC3\xA0 \xC3\xA9galit\xC3\xA9, celui de A)");
+#ifdef SORT_STATS
+  memset(&sort_stats_tls, 0, sizeof(sort_stats_tls));
+#endif
+  uint64_t start = get_nanoseconds();
+  list_merge_sort(list);
+  uint64_t t = get_nanoseconds() - start;
+  if (stats) {
+#ifdef SORT_STATS
+    *stats = sort_stats_tls;
+#else
+    memset(stats, 0, sizeof(*stats));
+#endif
   }
-  free_array(arr);
   return t;
 }
 
@@ -1234,36 +4932,126 @@ uint64_t sort_list_wrapper(AppData *app, LinkedList *list, int algo) {
 //                             GESTION DES ARBRES
 // =============================================================================
 
-TreeNode *create_tree_node(DataType type, const void *value) {
-  TreeNode *n = g_new0(TreeNode, 1);
-  size_t sz = get_element_size(type);
-  n->data = malloc(sz);
-  if (value) {
-    if (type == DATA_STRING)
-      *((char **)n->data) = g_strdup(*(char **)value);
-    else
-      memcpy(n->data, value, sz);
-  }
+// A node from pool holding a copy of *value (a standalone string)
+TreeNode *create_tree_node(NodePool *pool, DataType type, const void *value) {
+  TreeNode *n = node_pool_alloc(pool);
+  mem_store_value(MEM_TREE, type, NULL, n->data, value);
   return n;
 }
 
-void free_tree(TreeNode *root, DataType type) {
+static NodePool *tree_pool_new(void) {
+  return node_pool_new(MEM_TREE, sizeof(TreeNode), TRUE);
+}
+
+// GSList cells of n-ary children are GLib's; they are counted here
+static void tree_free_children(TreeNode *node) {
+  guint cells = g_slist_length(node->children);
+  mem_account(MEM_TREE, -(int64_t)(cells * sizeof(GSList)), -(int64_t)cells);
+  g_slist_free(node->children);
+  node->children = NULL;
+}
+
+// Returns the subtree's nodes to pool
+void free_tree(NodePool *pool, TreeNode *root, DataType type) {
   if (!root)
     return;
   if (root->children) {
     for (GSList *it = root->children; it; it = it->next)
-      free_tree((TreeNode *)it->data, type);
-    g_slist_free(root->children);
+      free_tree(pool, (TreeNode *)it->data, type);
+    tree_free_children(root);
   }
   if (root->left)
-    free_tree(root->left, type);
+    free_tree(pool, root->left, type);
   if (root->right)
-    free_tree(root->right, type);
-  if (type == DATA_STRING && root->data)
-    g_free(*(char **)root->data);
-  if (root->data)
-    free(root->data);
-  g_free(root);
+    free_tree(pool, root->right, type);
+  if (type == DATA_STRING)
+    str_release(MEM_TREE, *(char **)root->data);
+  node_pool_release(pool, root);
+}
+
+// What a tree holds outside its nodes: strings and n-ary child lists
+static void tree_release_contents(TreeNode *root, DataType type) {
+  if (!root)
+    return;
+  for (GSList *it = root->children; it; it = it->next)
+    tree_release_contents((TreeNode *)it->data, type);
+  tree_free_children(root);
+  tree_release_contents(root->left, type);
+  tree_release_contents(root->right, type);
+  if (type == DATA_STRING)
+    str_release(MEM_TREE, *(char **)root->data);
+}
+
+// Frees the whole tree of pool at once. Binary trees of numbers or chars
+// are not walked: their nodes go with the slabs.
+static void tree_pool_clear(NodePool *pool, TreeNode *root, DataType type) {
+  if (root && (type == DATA_STRING || root->children))
+    tree_release_contents(root, type);
+  node_pool_clear(pool);
+}
+
+// Drops the app's tree; its pool is kept for the next one
+static void app_clear_tree(AppData *app) {
+  tree_pool_clear(app->tree_nodes, app->tree_root, app->tree_data_type);
+  app->tree_root = NULL;
+}
+
+static NodePool *app_tree_pool(AppData *app) {
+  if (!app->tree_nodes)
+    app->tree_nodes = tree_pool_new();
+  return app->tree_nodes;
+}
+
+// Binary search tree primitives; equal keys go right
+static void bst_insert(TreeNode **root, TreeNode *node,
+                       int (*cmp)(const void *, const void *)) {
+  while (*root)
+    root = cmp(node->data, (*root)->data) < 0 ? &(*root)->left
+                                              : &(*root)->right;
+  *root = node;
+}
+
+static TreeNode *bst_find(TreeNode *root, const void *value,
+                          int (*cmp)(const void *, const void *)) {
+  while (root) {
+    int c = cmp(value, root->data);
+    if (c == 0)
+      return root;
+    root = c < 0 ? root->left : root->right;
+  }
+  return NULL;
+}
+
+// Frees the first node holding value. A node with two children swaps
+// values with its in-order successor, which is unlinked instead.
+static gboolean bst_remove(NodePool *pool, TreeNode **root,
+                           const void *value, DataType type) {
+  int (*cmp)(const void *, const void *) = get_compare_func(type);
+  TreeNode **link = root;
+  while (*link) {
+    int c = cmp(value, (*link)->data);
+    if (c == 0)
+      break;
+    link = c < 0 ? &(*link)->left : &(*link)->right;
+  }
+  TreeNode *del = *link;
+  if (!del)
+    return FALSE;
+  if (del->left && del->right) {
+    TreeNode **succ = &del->right;
+    while ((*succ)->left)
+      succ = &(*succ)->left;
+    char data[NODE_VALUE_SIZE];
+    memcpy(data, del->data, NODE_VALUE_SIZE);
+    memcpy(del->data, (*succ)->data, NODE_VALUE_SIZE);
+    memcpy((*succ)->data, data, NODE_VALUE_SIZE);
+    link = succ;
+    del = *succ;
+  }
+  *link = del->left ? del->left : del->right;
+  del->left = del->right = NULL;
+  free_tree(pool, del, type);
+  return TRUE;
 }
 
 static void _insert_nary_level(TreeNode *root, TreeNode *node, int degree) {
@@ -1274,6 +5062,7 @@ static void _insert_nary_level(TreeNode *root, TreeNode *node, int degree) {
     int c = g_slist_length(cur->children);
     if (c < degree) {
       cur->children = g_slist_append(cur->children, node);
+      mem_account(MEM_TREE, sizeof(GSList), 1);
       node->parent = cur;
       g_queue_free(q);
       return;
@@ -1288,7 +5077,6 @@ void insert_tree_random(AppData *app, size_t count) {
   if (!app)
     return;
   DataType t = app->tree_data_type;
-  srand(time(NULL));
 
   for (size_t i = 0; i < count; i++) {
     // Generate Random Value safely
@@ -1299,45 +5087,34 @@ void insert_tree_random(AppData *app, size_t count) {
     char *r_str = NULL;
 
     if (t == DATA_INT) {
-      r_int = rand() % 1000;
+      r_int = (int)rng_below(&app->rng, 1000);
       val_ptr = &r_int;
     } else if (t == DATA_FLOAT) {
-      r_float = (float)rand() / (RAND_MAX / 1000.0);
+      r_float = (float)(rng_double(&app->rng) * 1000.0);
       val_ptr = &r_float;
     } else if (t == DATA_CHAR) {
-      r_char = (char)('a' + rand() % 26);
+      r_char = (char)('a' + rng_below(&app->rng, 26));
       val_ptr = &r_char;
     } else if (t == DATA_STRING) {
-      r_str = generate_random_string();
+      r_str = generate_random_string(MEM_TREE, NULL, &app->rng);
       val_ptr = &r_str; // Point to char*
     }
 
     TreeNode *n = NULL;
     // Special handling if root doesn't exist
     if (!app->tree_root) {
-      app->tree_root = create_tree_node(t, val_ptr);
+      app->tree_root = create_tree_node(app_tree_pool(app), t, val_ptr);
     } else {
-      n = create_tree_node(t, val_ptr);
+      n = create_tree_node(app->tree_nodes, t, val_ptr);
       if (app->tree_is_nary) {
         _insert_nary_level((TreeNode *)app->tree_root, n,
                            app->tree_nary_degree);
       } else {
-        // BST Insert
-        TreeNode **ptr = (TreeNode **)&app->tree_root;
-        int (*cmp)(const void *, const void *) = get_compare_func(t);
-        while (*ptr) {
-          TreeNode *cur = *ptr;
-          if (cmp(n->data, cur->data) < 0)
-            ptr = &cur->left;
-          else
-            ptr = &cur->right;
-        }
-        *ptr = n;
+        bst_insert((TreeNode **)&app->tree_root, n, get_compare_func(t));
       }
     }
 
-    if (r_str)
-      g_free(r_str);
+    str_release(MEM_TREE, r_str); // create_tree_node made its copy
   }
 }
 
@@ -1355,11 +5132,10 @@ gboolean insert_tree_manual(AppData *app, const char *val_str) {
   else if (t == DATA_STRING)
     *(char **)v = g_strdup(val_str);
 
-  TreeNode *n = create_tree_node(t, v);
-  if (t != DATA_STRING)
-    free(v);
-  else
+  TreeNode *n = create_tree_node(app_tree_pool(app), t, v);
+  if (t == DATA_STRING)
     g_free(*(char **)v); // cleanup temp
+  free(v);
 
   if (!app->tree_root) {
     app->tree_root = n;
@@ -1369,15 +5145,7 @@ gboolean insert_tree_manual(AppData *app, const char *val_str) {
   if (app->tree_is_nary) {
     _insert_nary_level((TreeNode *)app->tree_root, n, app->tree_nary_degree);
   } else {
-    TreeNode **ptr = (TreeNode **)&app->tree_root;
-    int (*cmp)(const void *, const void *) = get_compare_func(t);
-    while (*ptr) {
-      if (cmp(n->data, (*ptr)->data) < 0)
-        ptr = &(*ptr)->left;
-      else
-        ptr = &(*ptr)->right;
-    }
-    *ptr = n;
+    bst_insert((TreeNode **)&app->tree_root, n, get_compare_func(t));
   }
   return TRUE;
 }
@@ -1472,8 +5240,7 @@ gboolean delete_tree_node(AppData *app, const char *val_str) {
 
   if (target == app->tree_root) {
     // Delete root -> delete all
-    free_tree((TreeNode *)app->tree_root, app->tree_data_type);
-    app->tree_root = NULL;
+    app_clear_tree(app);
     return TRUE;
   }
 
@@ -1481,13 +5248,14 @@ gboolean delete_tree_node(AppData *app, const char *val_str) {
   if (parent) {
     if (app->tree_is_nary) {
       parent->children = g_slist_remove(parent->children, target);
+      mem_account(MEM_TREE, -(int64_t)sizeof(GSList), -1);
     } else {
       if (parent->left == target)
         parent->left = NULL;
       else if (parent->right == target)
         parent->right = NULL;
     }
-    free_tree(target, app->tree_data_type); // Free subtree
+    free_tree(app->tree_nodes, target, app->tree_data_type); // Free subtree
     return TRUE;
   }
   return FALSE;
@@ -1519,20 +5287,24 @@ static int _cmp_wrapper_char(const void *a, const void *b) {
   return *(char *)a - *(char *)b;
 }
 static int _cmp_wrapper_str(const void *a, const void *b) {
-  return strcmp(*(char **)a, *(char **)b);
+  return str_compare(*(char **)a, *(char **)b);
 }
 
 // Standard BST insert - Removed unused function _bst_insert
 
-// Balanced BST construction from sorted array
-static TreeNode *_build_balanced(void **data_array, int start, int end,
-                                 DataType type) {
+// Balanced BST construction: relinks nodes[start..end] and moves the sorted
+// values (raw cell contents) into them in order
+static TreeNode *_build_balanced(TreeNode **nodes, const char *values,
+                                 size_t el_size, int start, int end,
+                                 TreeNode *parent) {
   if (start > end)
     return NULL;
   int mid = (start + end) / 2;
-  TreeNode *n = create_tree_node(type, data_array[mid]);
-  n->left = _build_balanced(data_array, start, mid - 1, type);
-  n->right = _build_balanced(data_array, mid + 1, end, type);
+  TreeNode *n = nodes[mid];
+  memcpy(n->data, values + mid * el_size, el_size);
+  n->parent = parent;
+  n->left = _build_balanced(nodes, values, el_size, start, mid - 1, n);
+  n->right = _build_balanced(nodes, values, el_size, mid + 1, end, n);
   return n;
 }
 
@@ -1549,25 +5321,19 @@ void reorder_tree(AppData *app) {
     return;
   }
 
-  // Extract raw data copies
+  // Extract the raw cell contents (string pointers are moved, not copied)
   size_t el_size = get_element_size(app->tree_data_type);
   int count = nodes->len;
   void *raw_data = malloc(count * el_size); // Array of values
 
   for (int i = 0; i < count; i++) {
     TreeNode *n = (TreeNode *)g_ptr_array_index(nodes, i);
-    void *dest = (char *)raw_data + i * el_size;
-    if (app->tree_data_type == DATA_STRING) {
-      *((char **)dest) = g_strdup(*(char **)n->data);
-    } else {
-      memcpy(dest, n->data, el_size);
-    }
+    memcpy((char *)raw_data + i * el_size, n->data, el_size);
   }
 
-  // 2. Clear old tree
-  free_tree((TreeNode *)app->tree_root, app->tree_data_type);
-  app->tree_root = NULL;
-  g_ptr_array_free(nodes, TRUE);
+  // 2. Unlink the old shape; the nodes and their cells are reused
+  for (int i = 0; i < count; i++)
+    tree_free_children((TreeNode *)g_ptr_array_index(nodes, i));
 
   // 3. Sort
   int (*cmp)(const void *, const void *);
@@ -1591,30 +5357,11 @@ void reorder_tree(AppData *app) {
   qsort(raw_data, count, el_size, cmp);
 
   // 4. Rebuild Balanced BST
-  // To handle strings correctly (pointer to pointer), we need careful passing
-  // The _build_balanced function expects array of pointers to data? No,
-  // raw_data is flat array. Exception: String is array of char* pointers.
-
-  // Actually, let's just make an array of void* pointers to the raw elements
-  // for easier indexing
-  void **ptr_array = malloc(count * sizeof(void *));
-  for (int i = 0; i < count; i++) {
-    ptr_array[i] = (char *)raw_data + i * el_size;
-  }
-
-  app->tree_root =
-      _build_balanced(ptr_array, 0, count - 1, app->tree_data_type);
+  app->tree_root = _build_balanced((TreeNode **)nodes->pdata, raw_data,
+                                   el_size, 0, count - 1, NULL);
   app->tree_is_nary = FALSE; // Enforced
 
-  free(ptr_array);
-
-  // Free raw string copies if string, but wait, create_tree_node copies them.
-  // So we must free own copies.
-  if (app->tree_data_type == DATA_STRING) {
-    for (int i = 0; i < count; i++) {
-      g_free(*((char **)raw_data + i));
-    }
-  }
+  g_ptr_array_free(nodes, TRUE);
   free(raw_data);
 
   set_status(app, "Arbre ordonné et équilibré (BST).");
@@ -1690,8 +5437,7 @@ TreeNode *convert_nary_to_binary(TreeNode *root) {
       prev = prev->right;
       it = it->next;
     }
-    g_slist_free(root->children);
-    root->children = NULL;
+    tree_free_children(root);
   }
   return root;
 }
@@ -1764,6 +5510,12 @@ void traverse_tree_dfs_post(TreeNode *root, GString *out, DataType type) {
   g_string_append(out, b);
 }
 
+// Kind of list chosen in the list view
+static StructureType app_list_kind(AppData *app) {
+  return STRUCTURE_SIMPLE_LIST +
+         gtk_combo_box_get_active(GTK_COMBO_BOX(app->list_type_combo));
+}
+
 void parse_and_fill_struct(AppData *app, const char *input, int struct_type) {
   if (!input || strlen(input) == 0)
     return;
@@ -1790,15 +5542,17 @@ void parse_and_fill_struct(AppData *app, const char *input, int struct_type) {
       else if (type_idx == DATA_CHAR)
         *(char *)ptr = tokens[i][0];
       else if (type_idx == DATA_STRING)
-        *((char **)ptr) = g_strdup(tokens[i]);
+        *((char **)ptr) =
+            str_new(MEM_ARRAY, app->original_array->strings, tokens[i]);
     }
   } else if (struct_type == 1) { // List
     if (app->current_list)
       free_linked_list(app->current_list);
-    app->current_list = create_linked_list(type_idx, FALSE);
-    for (int i = 0; i < count; i++) {
-      Node *n = create_node(type_idx, NULL);
-      void *ptr = n->data;
+    app->current_list = create_list(type_idx, app_list_kind(app));
+    list_append_zeroed(app->current_list, count);
+    ListIter it;
+    void *ptr = list_iter_begin(app->current_list, &it);
+    for (int i = 0; i < count; i++, ptr = list_iter_next(&it)) {
       if (type_idx == DATA_INT)
         *(int *)ptr = atoi(tokens[i]);
       else if (type_idx == DATA_FLOAT)
@@ -1806,14 +5560,11 @@ void parse_and_fill_struct(AppData *app, const char *input, int struct_type) {
       else if (type_idx == DATA_CHAR)
         *(char *)ptr = tokens[i][0];
       else if (type_idx == DATA_STRING)
-        *((char **)ptr) = g_strdup(tokens[i]);
-      insert_to_linkedlist(app->current_list, n, -1);
+        *((char **)ptr) =
+            str_new(MEM_LIST, app->current_list->strings, tokens[i]);
     }
   } else if (struct_type == 2) { // Tree
-    if (app->tree_root) {
-      free_tree((TreeNode *)app->tree_root, app->tree_data_type);
-      app->tree_root = NULL;
-    }
+    app_clear_tree(app);
     for (int i = 0; i < count; i++) {
       insert_tree_manual(app, tokens[i]);
     }
@@ -1828,13 +5579,38 @@ void parse_and_fill_struct(AppData *app, const char *input, int struct_type) {
 // =============================================================================
 
 Graph *create_graph(DataType type, gboolean directed) {
-  Graph *g = g_new0(Graph, 1);
+  Graph *g = mem_alloc0(MEM_GRAPH, sizeof(Graph));
   g->type = type;
   g->is_directed = directed;
   g->next_id_counter = 1;
+  if (type == DATA_STRING) // Labels repeat: each is stored once
+    g->strings = str_arena_new(MEM_GRAPH, TRUE);
   return g;
 }
 
+// Vertices own their value cell (from mem_new_value) and outgoing edges
+void free_graph(Graph *g) {
+  if (!g)
+    return;
+  for (GSList *l = g->nodes; l; l = l->next) {
+    GraphNode *n = (GraphNode *)l->data;
+    for (GSList *e = n->edges; e; e = e->next)
+      mem_free(MEM_GRAPH, e->data, sizeof(GraphEdge));
+    guint cells = g_slist_length(n->edges);
+    mem_account(MEM_GRAPH, -(int64_t)(cells * sizeof(GSList)),
+                -(int64_t)cells);
+    g_slist_free(n->edges);
+    mem_free_value(MEM_GRAPH, g->type, n->data);
+    mem_count_elements(MEM_GRAPH, -1);
+    mem_free(MEM_GRAPH, n, sizeof(GraphNode));
+  }
+  mem_account(MEM_GRAPH, -(int64_t)(g->node_count * sizeof(GSList)),
+              -(int64_t)g->node_count);
+  g_slist_free(g->nodes);
+  str_arena_unref(g->strings);
+  mem_free(MEM_GRAPH, g, sizeof(Graph));
+}
+
 // Helper to layout circular
 void layout_graph_circular(Graph *g, double cx, double cy, double radius) {
   if (!g || !g->nodes)
@@ -1856,8 +5632,9 @@ void layout_graph_circular(Graph *g, double cx, double cy, double radius) {
   }
 }
 
+// Takes ownership of data, a cell from mem_new_value(MEM_GRAPH, ...)
 GraphNode *create_graph_node(Graph *g, void *data) {
-  GraphNode *n = g_new0(GraphNode, 1);
+  GraphNode *n = mem_alloc0(MEM_GRAPH, sizeof(GraphNode));
   n->id = g->next_id_counter++;
   n->data = data;
 
@@ -1866,6 +5643,8 @@ GraphNode *create_graph_node(Graph *g, void *data) {
   n->y = 0;
 
   g->nodes = g_slist_append(g->nodes, n);
+  mem_account(MEM_GRAPH, sizeof(GSList), 1);
+  mem_count_elements(MEM_GRAPH, 1);
   g->node_count++;
   return n;
 }
@@ -1874,17 +5653,60 @@ void add_graph_edge(Graph *g, GraphNode *src, GraphNode *dest, double weight) {
   if (!g || !src || !dest)
     return;
 
-  GraphEdge *e = g_new0(GraphEdge, 1);
+  GraphEdge *e = mem_alloc0(MEM_GRAPH, sizeof(GraphEdge));
   e->target = dest;
   e->weight = weight;
   src->edges = g_slist_append(src->edges, e);
+  mem_account(MEM_GRAPH, sizeof(GSList), 1);
 
   if (!g->is_directed) {
-    GraphEdge *e2 = g_new0(GraphEdge, 1);
+    GraphEdge *e2 = mem_alloc0(MEM_GRAPH, sizeof(GraphEdge));
     e2->target = src;
     e2->weight = weight;
     dest->edges = g_slist_append(dest->edges, e2);
+    mem_account(MEM_GRAPH, sizeof(GSList), 1);
+  }
+}
+
+// A cycle through every vertex (so all are reachable) plus a chord from
+// about a third of them; weights are positive.
+Graph *generate_random_graph(DataType t, gboolean directed, int count,
+                             Rng *rng) {
+  Graph *g = create_graph(t, directed);
+  GraphNode **nodes = g_new0(GraphNode *, MAX(count, 1));
+
+  for (int i = 0; i < count; i++) {
+    void *val = mem_new_value(MEM_GRAPH, t, NULL, NULL);
+    if (t == DATA_INT)
+      *(int *)val = 10 + rng_below(rng, 90);
+    else if (t == DATA_CHAR)
+      *(char *)val = 'A' + rng_below(rng, 26);
+    else if (t == DATA_STRING) {
+      char label[16];
+      snprintf(label, sizeof(label), "N%u", 1 + rng_below(rng, 20));
+      *((char **)val) = str_new(MEM_GRAPH, g->strings, label);
+    } else
+      *(float *)val = (float)(10 + rng_below(rng, 90)) / 1.5;
+
+    nodes[i] = create_graph_node(g, val);
+  }
+
+  // Create a structured but varied graph
+  for (int i = 0; i < count && count > 1; i++) {
+    // Hamiltonian Cycle (ensures connectivity)
+    add_graph_edge(g, nodes[i], nodes[(i + 1) % count],
+                   5 + rng_below(rng, 15));
+
+    // Random additional edges for complexity (30% chance)
+    if (count > 3 && rng_below(rng, 100) < 35) {
+      int target = (i + 2 + rng_below(rng, count - 3)) % count;
+      if (target != i) {
+        add_graph_edge(g, nodes[i], nodes[target], 10 + rng_below(rng, 10));
+      }
+    }
   }
+  g_free(nodes);
+  return g;
 }
 
 GraphNode *find_graph_node_by_val(Graph *g, const char *val_str) {
@@ -1965,6 +5787,7 @@ static void find_paths_dfs(GraphNode *u, GraphNode *d, int *visited_ids,
 
 void find_all_paths(AppData *app, GraphNode *start, GraphNode *end,
                     GString *log) {
+  PROF_SCOPE("find_all_paths");
   if (!app->current_graph)
     return;
 
@@ -1999,8 +5822,163 @@ void reset_graph_algo_state(Graph *g) {
   }
 }
 
+// Shortest paths from start: each vertex gets its distance (1e18 when
+// unreachable) and predecessor. Dijkstra stops once end (may be NULL) is
+// settled and expects non-negative weights.
+void graph_dijkstra(Graph *g, GraphNode *start, GraphNode *end) {
+  PROF_SCOPE("graph_dijkstra");
+  reset_graph_algo_state(g);
+  start->dist = 0;
+  for (int i = 0; i < g->node_count; i++) {
+    GraphNode *u = NULL;
+    double min_d = 1e18;
+    for (GSList *l = g->nodes; l; l = l->next) {
+      GraphNode *x = (GraphNode *)l->data;
+      if (!x->visited && x->dist < min_d) {
+        min_d = x->dist;
+        u = x;
+      }
+    }
+
+    if (!u || min_d >= 1e18)
+      break;
+    u->visited = TRUE;
+    if (u == end)
+      break;
+
+    for (GSList *e_it = u->edges; e_it; e_it = e_it->next) {
+      GraphEdge *edge = (GraphEdge *)e_it->data;
+      GraphNode *v = edge->target;
+      if (!v->visited && u->dist + edge->weight < v->dist) {
+        v->dist = u->dist + edge->weight;
+        v->prev = u;
+      }
+    }
+  }
+}
+
+void graph_bellman_ford(Graph *g, GraphNode *start) {
+  PROF_SCOPE("graph_bellman_ford");
+  reset_graph_algo_state(g);
+  start->dist = 0;
+  for (int i = 0; i < g->node_count - 1; i++) {
+    gboolean changed = FALSE;
+    for (GSList *l = g->nodes; l; l = l->next) {
+      GraphNode *u = (GraphNode *)l->data;
+      if (u->dist >= 1e18)
+        continue;
+      for (GSList *e_it = u->edges; e_it; e_it = e_it->next) {
+        GraphEdge *edge = (GraphEdge *)e_it->data;
+        GraphNode *v = edge->target;
+        if (u->dist + edge->weight < v->dist) {
+          v->dist = u->dist + edge->weight;
+          v->prev = u;
+          changed = TRUE;
+        }
+      }
+    }
+    if (!changed)
+      break;
+  }
+}
+
+// All pairs; only the start -> end path is written back (prev, visited),
+// none when end is NULL.
+void graph_floyd_warshall(Graph *g, GraphNode *start, GraphNode *end) {
+  PROF_SCOPE("graph_floyd_warshall");
+  reset_graph_algo_state(g);
+  // Map Nodes to 0..N-1
+  int N = g->node_count;
+  GraphNode **map = g_new0(GraphNode *, N);
+  int idx = 0;
+  for (GSList *l = g->nodes; l; l = l->next)
+    map[idx++] = (GraphNode *)l->data;
+
+  // Indices of start/end
+  int s_idx = -1, e_idx = -1;
+  for (int i = 0; i < N; i++) {
+    if (map[i] == start)
+      s_idx = i;
+    if (map[i] == end)
+      e_idx = i;
+  }
+
+  // Init matrices
+  double *dist = g_new0(double, N *N);
+  int *next_hop = g_new0(int, N *N); // Store next node index
+
+  for (int i = 0; i < N * N; i++) {
+    dist[i] = 1e18;
+    next_hop[i] = -1;
+  }
+  for (int i = 0; i < N; i++)
+    dist[i * N + i] = 0;
+
+  // Fill edges
+  for (int i = 0; i < N; i++) {
+    for (GSList *e = map[i]->edges; e; e = e->next) {
+      GraphEdge *edge = (GraphEdge *)e->data;
+      int j = -1;
+      // Find j (inefficient but OK for N<100)
+      for (int k = 0; k < N; k++)
+        if (map[k] == edge->target) {
+          j = k;
+          break;
+        }
+
+      if (j != -1) {
+        if (edge->weight < dist[i * N + j]) {
+          dist[i * N + j] = edge->weight;
+          next_hop[i * N + j] = j;
+        }
+      }
+    }
+  }
+
+  // Core Algorithm
+  for (int k = 0; k < N; k++) {
+    for (int i = 0; i < N; i++) {
+      for (int j = 0; j < N; j++) {
+        if (dist[i * N + k] < 1e18 && dist[k * N + j] < 1e18) {
+          if (dist[i * N + k] + dist[k * N + j] < dist[i * N + j]) {
+            dist[i * N + j] = dist[i * N + k] + dist[k * N + j];
+            next_hop[i * N + j] = next_hop[i * N + k];
+          }
+        }
+      }
+    }
+  }
+
+  // Extract Result
+  start->dist = 0;
+  if (e_idx >= 0 && dist[s_idx * N + e_idx] < 1e18) {
+    end->dist = dist[s_idx * N + e_idx];
+
+    // Reconstruct path for visual highlight (set prev pointers)
+    int curr = s_idx;
+    while (curr != e_idx) {
+      int nxt = next_hop[curr * N + e_idx];
+      if (nxt == -1)
+        break;
+
+      map[nxt]->prev = map[curr];
+      map[curr]->visited = TRUE;
+      map[nxt]->visited = TRUE;
+
+      curr = nxt;
+    }
+  } else if (end) {
+    end->dist = 1e18;
+  }
+
+  g_free(dist);
+  g_free(next_hop);
+  g_free(map);
+}
+
 // 0=Dijkstra, 1=Bellman, 2=Floyd
 void run_graph_path(AppData *app, int algo_idx) {
+  PROF_SCOPE("run_graph_path");
   if (!app->current_graph)
     return;
 
@@ -2052,8 +6030,6 @@ void run_graph_path(AppData *app, int algo_idx) {
     }
   }
 
-  reset_graph_algo_state(app->current_graph);
-
   if (algo_idx == 2) {
     set_pseudo_code(app,
                     "FLOYD_WARSHALL(G):\n"
@@ -2067,100 +6043,8 @@ void run_graph_path(AppData *app, int algo_idx) {
                     "      Fin Pour\n"
                     "    Fin Pour\n"
                     "  Fin Pour");
-    // === FLOYD-WARSHALL ===
-    // Map Nodes to 0..N-1
-    int N = app->current_graph->node_count;
-    GraphNode **map = g_new0(GraphNode *, N);
-    int idx = 0;
-    for (GSList *l = app->current_graph->nodes; l; l = l->next)
-      map[idx++] = (GraphNode *)l->data;
-
-    // Indices of start/end
-    int s_idx = -1, e_idx = -1;
-    for (int i = 0; i < N; i++) {
-      if (map[i] == start)
-        s_idx = i;
-      if (map[i] == end)
-        e_idx = i;
-    }
-
-    // Init matrices
-    double *dist = g_new0(double, N *N);
-    int *next_hop = g_new0(int, N *N); // Store next node index
-
-    for (int i = 0; i < N * N; i++) {
-      dist[i] = 1e18;
-      next_hop[i] = -1;
-    }
-    for (int i = 0; i < N; i++)
-      dist[i * N + i] = 0;
-
-    // Fill edges
-    for (int i = 0; i < N; i++) {
-      for (GSList *e = map[i]->edges; e; e = e->next) {
-        GraphEdge *edge = (GraphEdge *)e->data;
-        int j = -1;
-        // Find j (inefficient but OK for N<100)
-        for (int k = 0; k < N; k++)
-          if (map[k] == edge->target) {
-            j = k;
-            break;
-          }
-
-        if (j != -1) {
-          if (edge->weight < dist[i * N + j]) {
-            dist[i * N + j] = edge->weight;
-            next_hop[i * N + j] = j;
-          }
-        }
-      }
-    }
-
-    // Core Algorithm
-    for (int k = 0; k < N; k++) {
-      for (int i = 0; i < N; i++) {
-        for (int j = 0; j < N; j++) {
-          if (dist[i * N + k] < 1e18 && dist[k * N + j] < 1e18) {
-            if (dist[i * N + k] + dist[k * N + j] < dist[i * N + j]) {
-              dist[i * N + j] = dist[i * N + k] + dist[k * N + j];
-              next_hop[i * N + j] = next_hop[i * N + k];
-            }
-          }
-        }
-      }
-    }
-
-    // Extract Result
-    start->dist = 0;
-    if (dist[s_idx * N + e_idx] < 1e18) {
-      end->dist = dist[s_idx * N + e_idx];
-
-      // Reconstruct path for visual highlight (set prev pointers)
-      int curr = s_idx;
-      while (curr != e_idx) {
-        int nxt = next_hop[curr * N + e_idx];
-        if (nxt == -1)
-          break;
-
-        map[nxt]->prev = map[curr];
-        map[curr]->visited = TRUE;
-        map[nxt]->visited = TRUE;
-
-        curr = nxt;
-      }
-    } else {
-      end->dist = 1e18;
-    }
-
-    g_free(dist);
-    g_free(next_hop);
-    g_free(map);
-
+    graph_floyd_warshall(app->current_graph, start, end);
   } else {
-    // === DIJKSTRA / BELLMAN-FORD ===
-    start->dist = 0;
-    int n_count = app->current_graph->node_count;
-
     if (algo_idx == 0) { // Dijkstra
       set_pseudo_code(app, "DIJKSTRA(G, source):\n"
                            "  Pour chaque sommet v dans G faire:\n"
@@ -2178,32 +6062,7 @@ void run_graph_path(AppData *app, int algo_idx) {
                            "      Fin Si\n"
                            "    Fin Pour\n"
                            "  Fin Tant que");
-      for (int i = 0; i < n_count; i++) {
-        GraphNode *u = NULL;
-        double min_d = 1e18;
-        for (GSList *l = app->current_graph->nodes; l; l = l->next) {
-          GraphNode *x = (GraphNode *)l->data;
-          if (!x->visited && x->dist < min_d) {
-            min_d = x->dist;
-            u = x;
-          }
-        }
-
-        if (!u || min_d >= 1e18)
-          break;
-        u->visited = TRUE;
-        if (u == end)
-          break;
-
-        for (GSList *e_it = u->edges; e_it; e_it = e_it->next) {
-          GraphEdge *edge = (GraphEdge *)e_it->data;
-          GraphNode *v = edge->target;
-          if (!v->visited && u->dist + edge->weight < v->dist) {
-            v->dist = u->dist + edge->weight;
-            v->prev = u;
-          }
-        }
-      }
+      graph_dijkstra(app->current_graph, start, end);
     } else { // Bellman-Ford
       set_pseudo_code(
           app, "BELLMAN_FORD(G, source):\n"
@@ -2218,25 +6077,7 @@ void run_graph_path(AppData *app, int algo_idx) {
                "      Fin Si\n"
                "    Fin Pour\n"
                "  Fin R\xC3\xA9p\xC3\xA9ter");
-      for (int i = 0; i < n_count - 1; i++) {
-        gboolean changed = FALSE;
-        for (GSList *l = app->current_graph->nodes; l; l = l->next) {
-          GraphNode *u = (GraphNode *)l->data;
-          if (u->dist >= 1e18)
-            continue;
-          for (GSList *e_it = u->edges; e_it; e_it = e_it->next) {
-            GraphEdge *edge = (GraphEdge *)e_it->data;
-            GraphNode *v = edge->target;
-            if (u->dist + edge->weight < v->dist) {
-              v->dist = u->dist + edge->weight;
-              v->prev = u;
-              changed = TRUE;
-            }
-          }
-        }
-        if (!changed)
-          break;
-      }
+      graph_bellman_ford(app->current_graph, start);
     }
   }
 
@@ -2420,53 +6261,30 @@ void show_graph_representation(AppData *app) {
   gtk_widget_destroy(dialog);
 }
 
+// Frees the current graph, and the selection pointing into it
+static void replace_current_graph(AppData *app, Graph *g) {
+  free_graph(app->current_graph);
+  app->current_graph = g;
+  app->graph_drag_node = NULL;
+  app->graph_sel_source = NULL;
+  app->graph_sel_dest = NULL;
+  app->graph_link_start = NULL;
+  app->graph_linking = FALSE;
+}
+
 void on_generate_graph(GtkWidget *widget, gpointer user_data) {
+  PROF_SCOPE("generate_graph");
   AppData *app = (AppData *)user_data;
   DataType t =
       gtk_combo_box_get_active(GTK_COMBO_BOX(app->graph_data_type_combo));
   int gtype_idx =
-      gtk_combo_box_get_active(GTK_COMBO_BOX(app->graph_type_combo));
-  gboolean directed = (gtype_idx == 0);
-
-  // Seed for true randomness
-  srand(time(NULL));
-
-  // Clear existing
-  app->current_graph = create_graph(t, directed);
-
-  // Randomize node count (5 to 8)
-  int count = 5 + (rand() % 4);
-  GraphNode **nodes = g_new0(GraphNode *, count);
-
-  for (int i = 0; i < count; i++) {
-    void *val = malloc(get_element_size(t));
-    if (t == DATA_INT)
-      *(int *)val = 10 + (rand() % 90);
-    else if (t == DATA_CHAR)
-      *(char *)val = 'A' + (rand() % 26);
-    else if (t == DATA_STRING)
-      *((char **)val) = g_strdup_printf("N%d", 1 + (rand() % 20));
-    else
-      *(float *)val = (float)(10 + (rand() % 90)) / 1.5;
-
-    nodes[i] = create_graph_node(app->current_graph, val);
-  }
-
-  // Create a structured but varied graph
-  for (int i = 0; i < count; i++) {
-    // Hamiltonian Cycle (ensures connectivity)
-    add_graph_edge(app->current_graph, nodes[i], nodes[(i + 1) % count],
-                   5 + (rand() % 15));
+      gtk_combo_box_get_active(GTK_COMBO_BOX(app->graph_type_combo));
+  gboolean directed = (gtype_idx == 0);
+  Rng *rng = &app->rng;
 
-    // Random additional edges for complexity (30% chance)
-    if (rand() % 100 < 35) {
-      int target = (i + 2 + (rand() % (count - 3))) % count;
-      if (target != i) {
-        add_graph_edge(app->current_graph, nodes[i], nodes[target],
-                       10 + (rand() % 10));
-      }
-    }
-  }
+  // Randomize node count (5 to 8)
+  int count = 5 + rng_below(rng, 4);
+  replace_current_graph(app, generate_random_graph(t, directed, count, rng));
 
   // Layout
   GtkAllocation alloc;
@@ -2484,7 +6302,6 @@ void on_generate_graph(GtkWidget *widget, gpointer user_data) {
   add_history_entry(app, "Génération Graphe Varié");
   update_dashboard_stats(app, 3, app->current_graph->node_count, 0);
   gtk_widget_queue_draw(app->graph_canvas);
-  g_free(nodes);
 }
 
 void on_graph_action(GtkWidget *widget, gpointer user_data) {
@@ -2504,20 +6321,20 @@ void on_graph_action(GtkWidget *widget, gpointer user_data) {
 
     // Generate Random Value Automatically
     static char rnd_buf[32];
-    srand(time(NULL) + rand()); // Mix logic
     if (app->current_graph->type == DATA_INT)
-      snprintf(rnd_buf, 32, "%d", rand() % 100);
+      snprintf(rnd_buf, 32, "%u", rng_below(&app->rng, 100));
     else if (app->current_graph->type == DATA_FLOAT)
-      snprintf(rnd_buf, 32, "%.1f", (float)(rand() % 1000) / 10.0);
+      snprintf(rnd_buf, 32, "%.1f", rng_below(&app->rng, 1000) / 10.0);
     else if (app->current_graph->type == DATA_CHAR)
-      snprintf(rnd_buf, 32, "%c", 'A' + rand() % 26);
+      snprintf(rnd_buf, 32, "%c", 'A' + rng_below(&app->rng, 26));
     else
-      snprintf(rnd_buf, 32, "N%d", rand() % 100);
+      snprintf(rnd_buf, 32, "N%u", rng_below(&app->rng, 100));
 
     const char *val = rnd_buf;
 
     // Parse value
-    void *data = malloc(get_element_size(app->current_graph->type));
+    void *data =
+        mem_new_value(MEM_GRAPH, app->current_graph->type, NULL, NULL);
     if (app->current_graph->type == DATA_INT)
       *(int *)data = atoi(val);
     else if (app->current_graph->type == DATA_FLOAT)
@@ -2525,7 +6342,7 @@ void on_graph_action(GtkWidget *widget, gpointer user_data) {
     else if (app->current_graph->type == DATA_CHAR)
       *(char *)data = val[0];
     else
-      *((char **)data) = g_strdup(val);
+      *((char **)data) = str_new(MEM_GRAPH, app->current_graph->strings, val);
 
     create_graph_node(app->current_graph, data);
 
@@ -2602,25 +6419,14 @@ void on_graph_action(GtkWidget *widget, gpointer user_data) {
     }
   } else if (g_strcmp0(id, "reset_graph") == 0) {
     if (app->current_graph) {
-      // Free graph logic should be robust
-      // For now, simpler: just nullify if we don't have deep free func ready
-      // (we do have free_graph logic? No, we have free_nodes logic?) We have
-      // create_graph but no destroy_graph fully? Let's iterate and free.
-      // ... Simple hack: just make a new empty graph
-
       DataType t =
           gtk_combo_box_get_active(GTK_COMBO_BOX(app->data_type_combo));
       int gtype_idx =
           gtk_combo_box_get_active(GTK_COMBO_BOX(app->graph_type_combo));
       gboolean directed = (gtype_idx == 0);
-      // Free nodes
-      // TODO: Real free
-      // ...
-
-      app->current_graph = create_graph(t, directed);
-      app->graph_sel_source = NULL;
-      app->graph_sel_dest = NULL;
+      replace_current_graph(app, create_graph(t, directed));
       gtk_widget_queue_draw(app->graph_canvas);
+      update_dashboard_stats(app, 3, 0, -1);
       set_status(app, "Graphe réinitialisé");
       set_pseudo_code(
           app,
@@ -2788,6 +6594,7 @@ gboolean on_graph_button_release(GtkWidget *widget, GdkEventButton *event,
 }
 
 gboolean on_draw_graph(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
+  PROF_SCOPE("on_draw_graph");
   AppData *app = (AppData *)user_data;
   if (!app->current_graph)
     return FALSE;
@@ -3030,6 +6837,7 @@ void draw_arrow(cairo_t *cr, double x1, double y1, double x2, double y2) {
 // =============================================================================
 
 gboolean on_draw_list(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
+  PROF_SCOPE("on_draw_list");
   AppData *app = (AppData *)user_data;
   LinkedList *list = app->current_list;
   GtkAllocation alloc;
@@ -3090,16 +6898,20 @@ gboolean on_draw_list(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
   if (nodes_per_row < 1)
     nodes_per_row = 1;
 
-  Node *cur = list->head;
+  // Unrolled lists link their blocks both ways, and values inside a block
+  // are side by side with no arrow between them
+  gboolean unrolled = list->kind == STRUCTURE_UNROLLED_LIST;
+  gboolean two_way = list->is_doubly_linked || unrolled;
+  ListIter it;
   size_t idx = 0;
-  while (cur) {
+  for (void *v = list_iter_begin(list, &it); v; v = list_iter_next(&it)) {
     int row = idx / nodes_per_row;
     int col = idx % nodes_per_row;
     int x = 20 + col * (NODE_W + PAD_X);
     int y = 40 + row * (NODE_H + PAD_Y);
 
     // Arrow
-    if (idx > 0) {
+    if (idx > 0 && (!unrolled || it.index == 0)) {
       int prev_row = (idx - 1) / nodes_per_row;
       int prev_col = (idx - 1) % nodes_per_row;
       int px = 20 + prev_col * (NODE_W + PAD_X);
@@ -3110,7 +6922,7 @@ gboolean on_draw_list(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
       if (row == prev_row) {
         // Horizontal
         double y_line = y + NODE_H / 2;
-        if (list->is_doubly_linked) {
+        if (two_way) {
           // Double: Upper arrow ->, Lower arrow <-
           draw_arrow(cr, px + NODE_W, y_line - 5, x, y_line - 5);
           draw_arrow(cr, x, y_line + 5, px + NODE_W, y_line + 5);
@@ -3125,7 +6937,7 @@ gboolean on_draw_list(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
         cairo_stroke(cr);
 
         // Simple indicator for direction
-        if (list->is_doubly_linked) {
+        if (two_way) {
           cairo_move_to(cr, px + NODE_W / 2 + 5, py + NODE_H);
           cairo_curve_to(cr, px + NODE_W / 2 + 5, py + NODE_H + 20,
                          x + NODE_W / 2 + 5, y - 20, x + NODE_W / 2 + 5, y);
@@ -3145,20 +6957,28 @@ gboolean on_draw_list(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
       cairo_set_source_rgb(cr, 0.3, 0.2, 0.7); // Darker Saphir
     cairo_stroke(cr);
 
+    // Skip list: one bar above the box per level beyond the first
+    if (it.skip) {
+      cairo_set_source_rgb(cr, accent_r, accent_g, accent_b);
+      for (int h = 1; h < MIN(it.skip->height, 7); h++)
+        cairo_rectangle(cr, x + 4, y - 5 * h, 14, 3);
+      cairo_fill(cr);
+    }
+
     // Text
     char b[32];
     switch (list->type) {
     case DATA_INT:
-      snprintf(b, 32, "%d", *(int *)cur->data);
+      snprintf(b, 32, "%d", *(int *)v);
       break;
     case DATA_FLOAT:
-      snprintf(b, 32, "%.2f", *(float *)cur->data);
+      snprintf(b, 32, "%.2f", *(float *)v);
       break;
     case DATA_CHAR:
-      snprintf(b, 32, "%c", *(char *)cur->data);
+      snprintf(b, 32, "%c", *(char *)v);
       break;
     case DATA_STRING:
-      snprintf(b, 32, "%.6s", *(char **)cur->data);
+      snprintf(b, 32, "%.6s", *(char **)v);
       break;
     default:
       snprintf(b, 32, "...");
@@ -3172,8 +6992,6 @@ gboolean on_draw_list(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
     cairo_move_to(cr, x + (NODE_W - ext.width) / 2,
                   y + (NODE_H + ext.height) / 2);
     cairo_show_text(cr, b);
-
-    cur = cur->next;
     idx++;
   }
   return FALSE;
@@ -3229,6 +7047,7 @@ static void assign_positions(TreeNode *root, GHashTable *pos_map,
 }
 
 gboolean on_draw_tree(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
+  PROF_SCOPE("on_draw_tree");
   AppData *app = (AppData *)user_data;
   if (!app->tree_root)
     return FALSE;
@@ -3276,8 +7095,10 @@ gboolean on_draw_tree(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
 
   GHashTable *pos_map = g_hash_table_new(g_direct_hash, g_direct_equal);
   double next_x = 0;
+  ProfSpan layout = prof_begin("assign_positions");
   assign_positions((TreeNode *)app->tree_root, pos_map, &next_x, 0,
                    app->tree_is_nary);
+  prof_end(layout);
 
   // Calc spacing
   int depth = tree_depth((TreeNode *)app->tree_root);
@@ -3453,13 +7274,774 @@ gboolean on_draw_tree(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
 //                             MODULE DE COMPARAISON (BENCHMARK)
 // =============================================================================
 
+// Largest benchmark size; the run is off the UI thread and cancellable
+#define BENCH_MAX_SIZE 1000000
+// Quadratic workloads (Bubble, Insertion, list operations away from the
+// head) are skipped beyond this size
+#define BENCH_QUADRATIC_MAX 20000
+// Sorted keys build a BST as deep as it is large, and the tree code recurses
+#define BENCH_TREE_MAX 20000
+#define BENCH_GRAPH_MAX 2000
+#define BENCH_CUBIC_MAX 500 // Floyd-Warshall
+
+// What a benchmark measures. Every curve is one operation timed over a
+// whole workload of size n (a sort, n insertions, a traversal of n nodes, a
+// shortest-path run on n vertices), so all suites plot and fit alike.
+typedef enum {
+  SUITE_SORT,  // Over arrays, or lists of a StructureType
+  SUITE_LIST,  // Linked-list insertions and deletions
+  SUITE_TREE,  // Binary search tree operations and traversals
+  SUITE_GRAPH, // Shortest paths on generated graphs
+  NUM_BENCH_SUITES
+} BenchSuite;
+
+typedef enum {
+  LIST_OP_INSERT_HEAD,
+  LIST_OP_INSERT_MIDDLE,
+  LIST_OP_INSERT_TAIL,
+  LIST_OP_DELETE_HEAD,
+  LIST_OP_DELETE_MIDDLE,
+  LIST_OP_DELETE_TAIL,
+  LIST_OP_SORT_MERGE, // Relinks the nodes
+  LIST_OP_SORT_ARRAY, // Tim Sort on an array copy, copies included
+  NUM_LIST_OPS
+} ListOp;
+
+typedef enum {
+  TREE_OP_INSERT,
+  TREE_OP_SEARCH,
+  TREE_OP_DELETE,
+  TREE_OP_REORDER,
+  TREE_OP_BFS,
+  TREE_OP_PREORDER,
+  TREE_OP_INORDER,
+  TREE_OP_POSTORDER,
+  NUM_TREE_OPS
+} TreeOp;
+
+typedef enum {
+  GRAPH_OP_DIJKSTRA,
+  GRAPH_OP_BELLMAN_FORD,
+  GRAPH_OP_FLOYD_WARSHALL,
+  NUM_GRAPH_OPS
+} GraphOp;
+
+// Timing protocol per point: warmup runs are discarded, then timed runs on
+// fresh copies of one input until max_runs or, past min_runs, until the
+// point has used its time budget.
+typedef struct {
+  int warmup;
+  int min_runs;
+  int max_runs;
+  uint64_t budget_ns;
+} BenchProtocol;
+
+#define BENCH_MIN_RUNS 3
+static const BenchProtocol bench_default_protocol = {1, BENCH_MIN_RUNS, 15,
+                                                     1000000000ull};
+
+// The worker sorts through ctx, a widget-less AppData with is_benchmarking
+// set, so nothing it calls touches GTK. Each point is posted back to the
+// main loop, which alone owns comparison_data.
+struct BenchJob {
+  AppData *app;
+  AppData ctx;
+  GThread *thread;
+  gint cancel;
+  size_t *sizes;
+  int num_sizes;
+  int num_algos; // Operations of the suite, one curve each
+  BenchSuite suite;
+  DataType type;
+  Distribution dist;
+  uint64_t seed;
+  StructureType structure; // Sort and list suites only
+  BenchProtocol proto;
+  int num_points; // Points the worker posts: the structure's operations only
+  int received;   // Points applied so far (main thread)
+};
+
+typedef struct {
+  BenchJob *job;
+  int curve;
+  int index;
+  PerformancePoint point;
+} BenchPoint;
+
+static const char *bench_algo_names[NUM_SORT_ALGOS] = {
+    "Bubble Sort", "Insertion Sort", "Shell Sort",    "Quick Sort",
+    "Intro Sort",  "Radix Sort",     "Parallel Sort", "Tim Sort"};
+
+// Names used in files: --bench options, CSV/JSON records, baselines
+static const char *bench_algo_keys[NUM_SORT_ALGOS] = {
+    "bubble", "insertion", "shell",    "quick",
+    "intro",  "radix",     "parallel", "tim"};
+static const char *bench_type_keys[] = {"int", "float", "char", "string"};
+static const char *structure_keys[NUM_STRUCTURES] = {
+    "array", "list", "dlist", "unrolled", "skip"};
+
+// Legend: growth of each curve's whole workload
+static const char *bench_algo_complexity[NUM_SORT_ALGOS] = {
+    "O(n\xC2\xB2)",     "O(n\xC2\xB2)", "O(n log\xC2\xB2 n)",
+    "O(n log n)",     "O(n log n)",   "O(n)",
+    "O(n log n / p)", "O(n log n)"};
+
+// Each list operation is applied n times to a list of n values, at the head,
+// the middle or the tail: insertions take the values of the list itself,
+// deletions empty it. The two sorts of a list of n values compare relinking
+// the nodes with sorting an array copy.
+static const char *list_op_names[NUM_LIST_OPS] = {
+    "Insertion en t\xC3\xAAte",   "Insertion au milieu",
+    "Insertion en queue",         "Suppression en t\xC3\xAAte",
+    "Suppression au milieu",      "Suppression en queue",
+    "Tri fusion (liens)",         "Tri via tableau"};
+static const char *list_op_keys[NUM_LIST_OPS] = {
+    "insert-head", "insert-middle", "insert-tail", "delete-head",
+    "delete-middle", "delete-tail", "sort-merge", "sort-array"};
+static const char *list_op_complexity[NUM_LIST_OPS] = {
+    "O(n)",       "O(n\xC2\xB2)", "O(n)",      "O(n)",
+    "O(n\xC2\xB2)", "O(n\xC2\xB2)", "O(n log n)", "O(n log n)"};
+
+// The keys are the benchmark input: insert builds the BST from them, search
+// and delete look each one up, the traversals walk the built tree once.
+static const char *tree_op_names[NUM_TREE_OPS] = {
+    "Insertion ABR",
+    "Recherche ABR",
+    "Suppression ABR",
+    "R\xC3\xA9\xC3\xA9quilibrage",
+    "Parcours largeur",
+    "Parcours pr\xC3\xA9\x66ixe",
+    "Parcours infixe",
+    "Parcours postfixe"};
+static const char *tree_op_keys[NUM_TREE_OPS] = {
+    "insert", "search",   "delete",  "reorder",
+    "bfs",    "preorder", "inorder", "postorder"};
+static const char *tree_op_complexity[NUM_TREE_OPS] = {
+    "O(n log n)", "O(n log n)", "O(n log n)", "O(n log n)",
+    "O(n)",       "O(n)",       "O(n)",       "O(n)"};
+
+// Shortest paths from the first vertex of a generate_random_graph() graph
+static const char *graph_op_names[NUM_GRAPH_OPS] = {"Dijkstra", "Bellman-Ford",
+                                                    "Floyd-Warshall"};
+static const char *graph_op_keys[NUM_GRAPH_OPS] = {"dijkstra", "bellman-ford",
+                                                   "floyd-warshall"};
+static const char *graph_op_complexity[NUM_GRAPH_OPS] = {
+    "O(V\xC2\xB2)", "O(V \xC2\xB7 E)", "O(V\xC2\xB3)"};
+
+typedef struct {
+  const char *key;   // --suite
+  const char *title; // Suite combo and chart title
+  int num_ops;
+  const char *const *names;
+  const char *const *keys; // --algos, records and baselines
+  const char *const *complexity;
+  size_t max_size;           // Largest n the window offers
+  size_t default_max;        // Window default when the view has no size
+  const char *default_sizes; // --sizes default
+} BenchSuiteInfo;
+
+static const BenchSuiteInfo bench_suites[NUM_BENCH_SUITES] = {
+    {"sort", "Tris", NUM_SORT_ALGOS, bench_algo_names, bench_algo_keys,
+     bench_algo_complexity, BENCH_MAX_SIZE, 1000, "1000,10000,100000"},
+    {"list", "Listes cha\xC3\xAEn\xC3\xA9" "es", NUM_LIST_OPS, list_op_names,
+     list_op_keys, list_op_complexity, BENCH_QUADRATIC_MAX, 1000,
+     "1000,2000,4000,8000"},
+    {"tree", "Arbres binaires de recherche", NUM_TREE_OPS, tree_op_names,
+     tree_op_keys, tree_op_complexity, BENCH_TREE_MAX, 5000,
+     "1000,2000,4000,8000"},
+    {"graph", "Graphes : plus courts chemins", NUM_GRAPH_OPS, graph_op_names,
+     graph_op_keys, graph_op_complexity, BENCH_GRAPH_MAX, 400,
+     "100,200,300,400"}};
+
+// Largest n worth measuring for one operation; the point is skipped beyond
+static size_t bench_op_max_size(BenchSuite suite, StructureType structure,
+                                int op) {
+  switch (suite) {
+  case SUITE_SORT:
+    return op == 0 || op == 1 ? BENCH_QUADRATIC_MAX : BENCH_MAX_SIZE;
+  case SUITE_LIST:
+    if (op == LIST_OP_SORT_MERGE && !list_kind_merge_sortable(structure))
+      return 0;
+    // A skip list reaches every position in O(log n), an unrolled list
+    // its tail in O(1)
+    if (structure == STRUCTURE_SKIP_LIST ||
+        (structure == STRUCTURE_UNROLLED_LIST && op == LIST_OP_DELETE_TAIL))
+      return BENCH_MAX_SIZE;
+    return op == LIST_OP_INSERT_MIDDLE || op == LIST_OP_DELETE_MIDDLE ||
+                   op == LIST_OP_DELETE_TAIL
+               ? BENCH_QUADRATIC_MAX
+               : BENCH_MAX_SIZE;
+  case SUITE_TREE:
+    return BENCH_TREE_MAX;
+  default:
+    return op == GRAPH_OP_FLOYD_WARSHALL ? BENCH_CUBIC_MAX : BENCH_GRAPH_MAX;
+  }
+}
+
+// Only Parallel Sort depends on the thread count
+static gboolean bench_op_threaded(BenchSuite suite, int op) {
+  return suite == SUITE_SORT && op == 6;
+}
+
+// Structure column of records and baselines
+static const char *bench_structure_key(BenchSuite suite,
+                                       StructureType structure) {
+  if (suite == SUITE_SORT || suite == SUITE_LIST)
+    return structure_keys[structure];
+  return bench_suites[suite].key;
+}
+
+static void free_comparison_data(AppData *app) {
+  for (int i = 0; i < BENCH_MAX_OPS; i++) {
+    if (app->comparison_data[i]) {
+      if (app->comparison_data[i]->points)
+        free(app->comparison_data[i]->points);
+      g_free(app->comparison_data[i]);
+      app->comparison_data[i] = NULL;
+    }
+  }
+}
+
+// Main thread: stores one finished point and moves the progress bar
+static gboolean bench_apply_point(gpointer data) {
+  BenchPoint *bp = (BenchPoint *)data;
+  BenchJob *job = bp->job;
+  AppData *app = job->app;
+
+  ComparisonCurve *curve = app->comparison_data[bp->curve];
+  curve->points[bp->index] = bp->point;
+  curve->num_points = bp->index + 1;
+  job->received++;
+
+  if (app->comparison_progress) {
+    int total = job->num_points;
+    char buf[96];
+    snprintf(buf, sizeof(buf), "%s : n = %zu (%d/%d)",
+             bench_suites[job->suite].names[bp->curve], bp->point.size,
+             job->received, total);
+    gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(app->comparison_progress),
+                                  (double)job->received / total);
+    gtk_progress_bar_set_text(GTK_PROGRESS_BAR(app->comparison_progress), buf);
+  }
+  if (app->comparison_canvas)
+    gtk_widget_queue_draw(app->comparison_canvas);
+  g_free(bp);
+  return G_SOURCE_REMOVE;
+}
+
+// Main thread: posted after the last point, so every point is applied
+static gboolean bench_finished(gpointer data) {
+  BenchJob *job = (BenchJob *)data;
+  AppData *app = job->app;
+  g_thread_join(job->thread);
+
+  gboolean cancelled = g_atomic_int_get(&job->cancel);
+  if (app->comparison_progress)
+    gtk_progress_bar_set_text(GTK_PROGRESS_BAR(app->comparison_progress),
+                              cancelled ? "Benchmark annul\xC3\xA9"
+                                        : "Benchmark termin\xC3\xA9");
+  if (app->comparison_cancel)
+    gtk_widget_set_sensitive(app->comparison_cancel, FALSE);
+  set_status(app, cancelled ? "Comparaison annul\xC3\xA9"
+                              "e (%d points)"
+                            : "Comparaison termin\xC3\xA9"
+                              "e (%d points)",
+             job->received);
+
+  app->bench_job = NULL;
+  g_free(job->sizes);
+  g_free(job);
+  if (app->comparison_restart && app->compare_window) {
+    app->comparison_restart = FALSE;
+    run_comparison_benchmark(app);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+static int compare_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+// Fills the timing fields of p from n samples (sorted in place). Slow
+// outliers past the upper Tukey fence (Q3 + 1.5 IQR) are dropped first; the
+// median's confidence interval comes from order statistics, so it holds
+// whatever the distribution of the noise.
+static void bench_summarize(uint64_t *samples, int n, PerformancePoint *p) {
+  qsort(samples, n, sizeof(uint64_t), compare_u64);
+  if (n >= 4) {
+    double q1 = (double)samples[n / 4], q3 = (double)samples[(3 * n) / 4];
+    double fence = q3 + 1.5 * (q3 - q1);
+    while (n > BENCH_MIN_RUNS && (double)samples[n - 1] > fence)
+      n--;
+  }
+
+  double mean = 0, var = 0;
+  for (int i = 0; i < n; i++)
+    mean += (double)samples[i];
+  mean /= n;
+  for (int i = 0; i < n; i++)
+    var += ((double)samples[i] - mean) * ((double)samples[i] - mean);
+
+  int p95 = (int)ceil(0.95 * n) - 1;
+  double h = 0.98 * sqrt((double)n); // 1.96 * sqrt(n) / 2
+  int lo = (int)floor(n / 2.0 - h), hi = (int)ceil(n / 2.0 + h);
+
+  p->runs = n;
+  p->time_min = (double)samples[0];
+  p->time_ns = n % 2 ? (double)samples[n / 2]
+                     : ((double)samples[n / 2 - 1] + samples[n / 2]) / 2.0;
+  p->time_p95 = (double)samples[CLAMP(p95, 0, n - 1)];
+  p->time_stddev = n > 1 ? sqrt(var / (n - 1)) : 0;
+  p->time_ci_lo = (double)samples[CLAMP(lo, 0, n - 1)];
+  p->time_ci_hi = (double)samples[CLAMP(hi, 0, n - 1)];
+}
+
+// --- Hardware counters ---
+// On Linux each timed run is bracketed by perf_event_open counters on the
+// calling thread. They are inherited by threads started after them, so the
+// Parallel Sort workers are included: benchmarks sort with pools of their own
+// (task_pools_begin_private), started once the counters are open. When the kernel refuses an event (no
+// PMU, perf_event_paranoid, containers) its bit stays clear in hw_valid.
+typedef struct {
+  int fd[NUM_HW_COUNTERS]; // -1 when the event could not be opened
+} PerfCounters;
+
+static const char *hw_counter_keys[NUM_HW_COUNTERS] = {
+    "cycles", "instructions", "cache_misses", "branch_misses", "llc_misses"};
+
+// NULL when no event at all is available
+static PerfCounters *perf_counters_open(void) {
+#ifdef HAVE_PERF_EVENTS
+  static const struct {
+    uint32_t type;
+    uint64_t config;
+  } events[NUM_HW_COUNTERS] = {
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+      {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL |
+                               (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                               (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)}};
+  PerfCounters *pc = g_new(PerfCounters, 1);
+  int opened = 0;
+  for (int i = 0; i < NUM_HW_COUNTERS; i++) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = events[i].type;
+    attr.config = events[i].config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format =
+        PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    pc->fd[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (pc->fd[i] >= 0)
+      opened++;
+  }
+  if (opened == 0) {
+    g_free(pc);
+    return NULL;
+  }
+  return pc;
+#else
+  return NULL;
+#endif
+}
+
+static void perf_counters_close(PerfCounters *pc) {
+  if (!pc)
+    return;
+#ifdef HAVE_PERF_EVENTS
+  for (int i = 0; i < NUM_HW_COUNTERS; i++)
+    if (pc->fd[i] >= 0)
+      close(pc->fd[i]);
+#endif
+  g_free(pc);
+}
+
+static void perf_counters_start(PerfCounters *pc) {
+#ifdef HAVE_PERF_EVENTS
+  for (int i = 0; pc && i < NUM_HW_COUNTERS; i++) {
+    if (pc->fd[i] >= 0) {
+      ioctl(pc->fd[i], PERF_EVENT_IOC_RESET, 0);
+      ioctl(pc->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+#endif
+}
+
+// Returns the hw_valid mask of the counts stored in out. Events the PMU
+// multiplexed are scaled by enabled/running time.
+static unsigned perf_counters_stop(PerfCounters *pc, uint64_t *out) {
+  unsigned valid = 0;
+#ifdef HAVE_PERF_EVENTS
+  for (int i = 0; pc && i < NUM_HW_COUNTERS; i++) {
+    if (pc->fd[i] < 0)
+      continue;
+    ioctl(pc->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+    uint64_t v[3]; // value, time enabled, time running
+    if (read(pc->fd[i], v, sizeof(v)) != (ssize_t)sizeof(v) || v[2] == 0)
+      continue;
+    out[i] = v[2] < v[1] ? (uint64_t)((double)v[0] * v[1] / v[2]) : v[0];
+    valid |= 1u << i;
+  }
+#endif
+  return valid;
+}
+
+// What every run of a point starts from. Runs that consume or reshape the
+// structure work on a copy made before the clock starts.
+typedef struct {
+  Array *array;     // Sorts over arrays, tree keys
+  LinkedList *list; // Sorts over lists, list operations
+  TreeNode *tree;   // BST of the keys, for searches and traversals
+  NodePool *tree_nodes;
+  Graph *graph;
+} BenchInput;
+
+// Keeps the searches from being optimised away
+static volatile size_t bench_sink;
+
+static TreeNode *bench_build_bst(NodePool *pool, const Array *keys) {
+  int (*cmp)(const void *, const void *) = get_compare_func(keys->type);
+  TreeNode *root = NULL;
+  node_pool_reserve(pool, keys->size);
+  for (size_t i = 0; i < keys->size; i++)
+    bst_insert(&root,
+               create_tree_node(pool, keys->type,
+                                (char *)keys->data + i * keys->element_size),
+               cmp);
+  return root;
+}
+
+static uint64_t bench_run_list_op(AppData *ctx, const BenchInput *in, int op,
+                                  SortStats *ops, PerfCounters *perf,
+                                  uint64_t *hw, unsigned *hw_valid) {
+  LinkedList *l = copy_linked_list(in->list);
+  size_t n = in->list->size;
+  perf_counters_start(perf);
+  uint64_t start = get_nanoseconds();
+  if (op >= LIST_OP_SORT_MERGE) {
+    sort_list_wrapper(ctx, l, op == LIST_OP_SORT_MERGE ? LIST_MERGE_SORT : 7,
+                      ops);
+  } else if (op <= LIST_OP_INSERT_TAIL) {
+    ListIter it;
+    for (void *v = list_iter_begin(in->list, &it); v; v = list_iter_next(&it)) {
+      int pos = op == LIST_OP_INSERT_HEAD     ? 0
+                : op == LIST_OP_INSERT_MIDDLE ? (int)(l->size / 2)
+                                              : -1;
+      list_insert_value(l, v, pos);
+    }
+  } else {
+    for (size_t i = 0; i < n; i++) {
+      int pos = op == LIST_OP_DELETE_HEAD     ? 0
+                : op == LIST_OP_DELETE_MIDDLE ? (int)(l->size / 2)
+                                              : (int)l->size - 1;
+      delete_from_linkedlist(l, pos);
+    }
+  }
+  uint64_t t = get_nanoseconds() - start;
+  *hw_valid = perf_counters_stop(perf, hw);
+  free_linked_list(l);
+  return t;
+}
+
+// ctx lends its tree fields to reorder_tree()
+static uint64_t bench_run_tree_op(AppData *ctx, const BenchInput *in, int op,
+                                  PerfCounters *perf, uint64_t *hw,
+                                  unsigned *hw_valid) {
+  const Array *keys = in->array;
+  DataType type = keys->type;
+  int (*cmp)(const void *, const void *) = get_compare_func(type);
+  NodePool *pool = tree_pool_new();
+  TreeNode *root = NULL;
+  GString *out = NULL;
+  if (op == TREE_OP_DELETE || op == TREE_OP_REORDER)
+    root = bench_build_bst(pool, keys);
+  else if (op >= TREE_OP_BFS)
+    out = g_string_sized_new(keys->size * 8);
+
+  perf_counters_start(perf);
+  uint64_t start = get_nanoseconds();
+  size_t found = 0;
+  switch (op) {
+  case TREE_OP_INSERT:
+    root = bench_build_bst(pool, keys);
+    break;
+  case TREE_OP_SEARCH:
+    for (size_t i = 0; i < keys->size; i++)
+      found += bst_find(in->tree, (char *)keys->data + i * keys->element_size,
+                        cmp) != NULL;
+    break;
+  case TREE_OP_DELETE:
+    for (size_t i = 0; i < keys->size; i++)
+      bst_remove(pool, &root, (char *)keys->data + i * keys->element_size,
+                 type);
+    break;
+  case TREE_OP_REORDER:
+    ctx->tree_root = root;
+    ctx->tree_data_type = type;
+    ctx->tree_is_nary = FALSE;
+    reorder_tree(ctx);
+    root = ctx->tree_root;
+    ctx->tree_root = NULL;
+    break;
+  case TREE_OP_BFS:
+    traverse_tree_bfs(in->tree, out, type);
+    break;
+  case TREE_OP_PREORDER:
+    traverse_tree_dfs_pre(in->tree, out, type);
+    break;
+  case TREE_OP_INORDER:
+    traverse_tree_dfs_in(in->tree, out, type);
+    break;
+  case TREE_OP_POSTORDER:
+    traverse_tree_dfs_post(in->tree, out, type);
+    break;
+  }
+  uint64_t t = get_nanoseconds() - start;
+  *hw_valid = perf_counters_stop(perf, hw);
+  bench_sink = found;
+  tree_pool_clear(pool, root, type);
+  node_pool_free(pool);
+  if (out)
+    g_string_free(out, TRUE);
+  return t;
+}
+
+// The algorithms only rewrite the vertices' dist/prev/visited fields, so
+// every run shares the input graph.
+static uint64_t bench_run_graph_op(const BenchInput *in, int op,
+                                   PerfCounters *perf, uint64_t *hw,
+                                   unsigned *hw_valid) {
+  Graph *g = in->graph;
+  GraphNode *source = (GraphNode *)g->nodes->data;
+  perf_counters_start(perf);
+  uint64_t start = get_nanoseconds();
+  if (op == GRAPH_OP_DIJKSTRA)
+    graph_dijkstra(g, source, NULL);
+  else if (op == GRAPH_OP_BELLMAN_FORD)
+    graph_bellman_ford(g, source);
+  else
+    graph_floyd_warshall(g, source, NULL);
+  uint64_t t = get_nanoseconds() - start;
+  *hw_valid = perf_counters_stop(perf, hw);
+  return t;
+}
+
+// One run of operation op on the input, so every run sees the same data.
+// perf (may be NULL) counts the timed part only; the mask of measured
+// counters is returned in hw_valid. Sorts also fill ops.
+static uint64_t bench_run_once(AppData *ctx, BenchSuite suite,
+                               StructureType structure, const BenchInput *in,
+                               int op, SortStats *ops, PerfCounters *perf,
+                               uint64_t *hw, unsigned *hw_valid) {
+  uint64_t t;
+  if (suite == SUITE_LIST)
+    return bench_run_list_op(ctx, in, op, ops, perf, hw, hw_valid);
+  if (suite == SUITE_TREE)
+    return bench_run_tree_op(ctx, in, op, perf, hw, hw_valid);
+  if (suite == SUITE_GRAPH)
+    return bench_run_graph_op(in, op, perf, hw, hw_valid);
+  if (structure != STRUCTURE_ARRAY) {
+    LinkedList *l = copy_linked_list(in->list);
+    perf_counters_start(perf);
+    t = sort_list_wrapper(ctx, l, op, ops);
+    *hw_valid = perf_counters_stop(perf, hw);
+    free_linked_list(l);
+  } else {
+    Array *arr = copy_array(in->array);
+    perf_counters_start(perf);
+    t = sort_array_wrapper(ctx, arr, op, ops);
+    *hw_valid = perf_counters_stop(perf, hw);
+    free_array(arr);
+  }
+  return t;
+}
+
+// Same run seed, suite, type, shape and size: same input for every
+// operation, and the same values in every kind of list
+static uint64_t bench_input_seed(uint64_t seed, BenchSuite suite,
+                                 DataType type, Distribution dist,
+                                 StructureType structure, size_t n) {
+  uint64_t is_list = structure != STRUCTURE_ARRAY;
+  uint64_t x = seed ^ ((uint64_t)type << 56) ^ ((uint64_t)dist << 48) ^
+               (is_list << 47) ^ ((uint64_t)suite << 40) ^ n;
+  return splitmix64(&x);
+}
+
+// The structure whose footprint a point reports
+static MemKind bench_mem_kind(BenchSuite suite, StructureType structure) {
+  switch (suite) {
+  case SUITE_LIST:
+    return MEM_LIST;
+  case SUITE_TREE:
+    return MEM_TREE;
+  case SUITE_GRAPH:
+    return MEM_GRAPH;
+  default:
+    return structure != STRUCTURE_ARRAY ? MEM_LIST : MEM_ARRAY;
+  }
+}
+
+static void bench_input_build(BenchInput *in, BenchSuite suite,
+                              DataType type, Distribution dist,
+                              StructureType structure, size_t sz, Rng *rng) {
+  memset(in, 0, sizeof(*in));
+  if (suite == SUITE_GRAPH) {
+    in->graph = generate_random_graph(type, TRUE, (int)sz, rng);
+  } else if (suite == SUITE_LIST ||
+             (suite == SUITE_SORT && structure != STRUCTURE_ARRAY)) {
+    in->list = create_list(type, structure);
+    fill_linked_list_dist(in->list, sz, dist, rng);
+  } else {
+    in->array = create_array(type, sz);
+    fill_array_dist(in->array, dist, rng);
+    if (suite == SUITE_TREE) {
+      in->tree_nodes = tree_pool_new();
+      in->tree = bench_build_bst(in->tree_nodes, in->array);
+    }
+  }
+}
+
+static void bench_input_free(BenchInput *in, DataType type) {
+  if (in->array)
+    free_array(in->array);
+  if (in->list)
+    free_linked_list(in->list);
+  if (in->tree_nodes) {
+    tree_pool_clear(in->tree_nodes, in->tree, type);
+    node_pool_free(in->tree_nodes);
+  }
+  if (in->graph)
+    free_graph(in->graph);
+}
+
+// Measures one point through ctx (never a UI AppData: see BenchJob).
+// Returns FALSE when cancel (may be NULL) is raised before the first run.
+static gboolean bench_measure_point(AppData *ctx, const BenchProtocol *proto,
+                                    PerfCounters *perf, uint64_t seed,
+                                    BenchSuite suite, DataType type,
+                                    Distribution dist, StructureType structure,
+                                    int algo, size_t sz, gint *cancel,
+                                    PerformancePoint *p) {
+  PROF_SCOPE("bench_measure_point");
+  Rng rng;
+  rng_seed(&rng, bench_input_seed(seed, suite, type, dist, structure, sz));
+  MemKind kind = bench_mem_kind(suite, structure);
+  MemStats before = mem_stats_get(kind);
+  BenchInput input;
+  bench_input_build(&input, suite, type, dist, structure, sz, &rng);
+  MemStats after = mem_stats_get(kind);
+  p->mem_bytes = after.live_bytes - before.live_bytes;
+  p->mem_blocks = after.live_blocks - before.live_blocks;
+
+  int cap = MAX(proto->max_runs, 1);
+  uint64_t *samples = g_new(uint64_t, cap);
+  uint64_t *hw = g_new(uint64_t, (size_t)cap * NUM_HW_COUNTERS);
+  uint64_t spent = 0, hw_scratch[NUM_HW_COUNTERS];
+  unsigned valid;
+  int n = 0;
+  // Starts the workers outside the timed runs
+  int threads = resolve_sort_threads(ctx->sort_threads);
+  if (bench_op_threaded(suite, algo) && threads > 1)
+    task_pool_release(task_pool_acquire(threads));
+  for (int w = 0; w < proto->warmup; w++)
+    spent += bench_run_once(ctx, suite, structure, &input, algo, NULL, NULL,
+                            hw_scratch, &valid);
+  p->hw_valid = ~0u;
+  while (n < proto->max_runs && !(cancel && g_atomic_int_get(cancel))) {
+    samples[n] = bench_run_once(ctx, suite, structure, &input, algo,
+                                n == 0 ? &p->ops : NULL, perf,
+                                hw + (size_t)n * NUM_HW_COUNTERS, &valid);
+    p->hw_valid &= valid; // Only counters read on every run
+    spent += samples[n++];
+    if (n >= proto->min_runs && spent >= proto->budget_ns)
+      break;
+  }
+
+  bench_input_free(&input, type);
+  if (n > 0) {
+    bench_summarize(samples, n, p);
+    for (int c = 0; c < NUM_HW_COUNTERS; c++) {
+      if (!(p->hw_valid & (1u << c)))
+        continue;
+      for (int r = 0; r < n; r++)
+        samples[r] = hw[(size_t)r * NUM_HW_COUNTERS + c];
+      qsort(samples, n, sizeof(uint64_t), compare_u64);
+      p->hw[c] = samples[n / 2];
+    }
+  } else {
+    p->hw_valid = 0;
+  }
+  g_free(samples);
+  g_free(hw);
+  return n > 0;
+}
+
+static gpointer bench_worker_main(gpointer data) {
+  BenchJob *job = (BenchJob *)data;
+  prof_thread_name("benchmark");
+  PerfCounters *perf = perf_counters_open(); // Counts this thread
+  task_pools_begin_private();
+  for (int a = 0; a < job->num_algos; a++) {
+    if (bench_op_max_size(job->suite, job->structure, a) == 0)
+      continue; // Operation the structure does not offer
+    for (int s = 0; s < job->num_sizes; s++) {
+      if (g_atomic_int_get(&job->cancel))
+        break;
+      BenchPoint *bp = g_new0(BenchPoint, 1);
+      bp->job = job;
+      bp->curve = a;
+      bp->index = s;
+      bp->point.size = job->sizes[s];
+
+      // Slow operations beyond their limit are left at runs == 0
+      if (job->sizes[s] <= bench_op_max_size(job->suite, job->structure, a) &&
+          !bench_measure_point(&job->ctx, &job->proto, perf, job->seed,
+                               job->suite, job->type, job->dist,
+                               job->structure, a, job->sizes[s], &job->cancel,
+                               &bp->point)) {
+        g_free(bp);
+        break;
+      }
+      g_idle_add(bench_apply_point, bp);
+    }
+  }
+  task_pools_end_private();
+  perf_counters_close(perf);
+  g_idle_add(bench_finished, job);
+  return NULL;
+}
+
+// Stops the running benchmark after its current sort
+static void cancel_comparison_benchmark(AppData *app) {
+  if (app && app->bench_job)
+    g_atomic_int_set(&app->bench_job->cancel, 1);
+}
+
+static void on_compare_cancel(GtkWidget *widget, gpointer user_data) {
+  cancel_comparison_benchmark((AppData *)user_data);
+}
+
 void run_comparison_benchmark(AppData *app) {
-  if (!app)
+  if (!app || app->bench_job)
     return;
-  app->is_benchmarking = TRUE;
+
+  // The curves follow the suite picked in the toolbar
+  if (app->comparison_suite_combo)
+    app->comparison_suite = gtk_combo_box_get_active(
+        GTK_COMBO_BOX(app->comparison_suite_combo));
+  BenchSuite suite =
+      (BenchSuite)CLAMP(app->comparison_suite, 0, NUM_BENCH_SUITES - 1);
+  const BenchSuiteInfo *info = &bench_suites[suite];
 
   // Determine Max Size from User Input
-  size_t user_max = 1000;
+  size_t user_max = info->default_max;
 
   // Check which view is active
   const char *vis_child =
@@ -3472,98 +8054,347 @@ void run_comparison_benchmark(AppData *app) {
     entry_text = gtk_entry_get_text(GTK_ENTRY(app->list_size_entry));
   }
 
-  if (entry_text && strlen(entry_text) > 0) {
+  // The entry sizes the structure it belongs to
+  if ((suite == SUITE_SORT || suite == SUITE_LIST) && entry_text &&
+      strlen(entry_text) > 0) {
     user_max = atoi(entry_text);
   }
 
   if (user_max < 100)
     user_max = 100;
-  // Cap at 15000 to prevent freezing with O(N^2) algorithms
-  if (user_max > 15000)
-    user_max = 15000;
-
-  // Validate: Don't run if size is 0 or invalid
-  if (user_max == 0) {
-    set_status(app, "Erreur: Taille invalide pour la comparaison");
-    return;
+  if (user_max > info->max_size)
+    user_max = info->max_size;
+
+  BenchJob *job = g_new0(BenchJob, 1);
+  job->app = app;
+  job->ctx.sort_threads = app->sort_threads;
+  job->ctx.is_benchmarking = TRUE;
+  job->suite = suite;
+  // Lists are measured in the kind chosen in the list view
+  gboolean list_view = g_strcmp0(vis_child, "view_list") == 0;
+  job->structure = list_view ? app_list_kind(app) : STRUCTURE_ARRAY;
+  if (suite == SUITE_LIST && !list_view)
+    job->structure = STRUCTURE_SIMPLE_LIST;
+  switch (suite) {
+  case SUITE_LIST:
+    job->type = app->current_list ? app->current_list->type : DATA_INT;
+    break;
+  case SUITE_TREE:
+    job->type = app->tree_root ? app->tree_data_type : DATA_INT;
+    break;
+  case SUITE_GRAPH:
+    job->type = app->current_graph ? app->current_graph->type : DATA_INT;
+    break;
+  default:
+    job->type = app->original_array ? app->original_array->type : DATA_INT;
+    break;
   }
+  job->dist = get_dist_combo(list_view ? app->list_dist_combo
+                                       : app->array_dist_combo);
+  job->num_algos = info->num_ops;
+  job->proto = bench_default_protocol;
+  job->seed = rng_next(&app->rng);
 
   // Generate 5 dynamic steps
-  int num_sizes = 5;
-  size_t *sizes = malloc(sizeof(size_t) * num_sizes);
-  for (int i = 0; i < num_sizes; i++) {
-    sizes[i] = (user_max * (i + 1)) / num_sizes;
+  job->num_sizes = 5;
+  job->sizes = g_new(size_t, job->num_sizes);
+  for (int i = 0; i < job->num_sizes; i++)
+    job->sizes[i] = (user_max * (i + 1)) / job->num_sizes;
+
+  // Curves start empty and fill up as the worker posts points
+  free_comparison_data(app);
+  g_free(app->test_sizes);
+  app->test_sizes = g_new(size_t, job->num_sizes);
+  memcpy(app->test_sizes, job->sizes, job->num_sizes * sizeof(size_t));
+  app->num_curves = job->num_algos;
+  app->num_sizes = job->num_sizes;
+  app->comparison_dist = job->dist;
+  app->comparison_type = job->type;
+  app->comparison_structure = job->structure;
+  app->comparison_threads = resolve_sort_threads(app->sort_threads);
+  for (int a = 0; a < job->num_algos; a++) {
+    if (bench_op_max_size(suite, job->structure, a) == 0)
+      continue; // No curve: the structure does not offer the operation
+    ComparisonCurve *curve = g_new0(ComparisonCurve, 1);
+    curve->algo_name = (char *)info->names[a]; // static string
+    curve->algo_index = a;
+    curve->points = calloc(job->num_sizes, sizeof(PerformancePoint));
+    app->comparison_data[a] = curve;
+    job->num_points += job->num_sizes;
   }
 
-  const char *algo_names[] = {"Bubble Sort", "Insertion Sort", "Shell Sort",
-                              "Quick Sort"};
-  int algos[] = {0, 1, 2, 3};
-  int num_algos = 4;
+  if (app->comparison_progress) {
+    gtk_progress_bar_set_show_text(GTK_PROGRESS_BAR(app->comparison_progress),
+                                   TRUE);
+    gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(app->comparison_progress),
+                                  0.0);
+    gtk_progress_bar_set_text(GTK_PROGRESS_BAR(app->comparison_progress),
+                              "D\xC3\xA9marrage...");
+  }
+  if (app->comparison_cancel)
+    gtk_widget_set_sensitive(app->comparison_cancel, TRUE);
+  if (app->comparison_canvas)
+    gtk_widget_queue_draw(app->comparison_canvas);
 
-  app->num_curves = num_algos;
-  app->num_sizes = num_sizes;
+  app->bench_job = job;
+  job->thread = g_thread_new("benchmark", bench_worker_main, job);
+}
 
-  // Clean up old
-  for (int i = 0; i < 8; i++) {
-    if (app->comparison_data[i]) {
-      if (app->comparison_data[i]->points)
-        free(app->comparison_data[i]->points);
-      g_free(app->comparison_data[i]);
-      app->comparison_data[i] = NULL;
+// What the comparison chart plots against n
+typedef enum {
+  METRIC_TIME,
+  METRIC_COMPARISONS,
+  METRIC_SWAPS_MOVES,
+  METRIC_BYTES,
+  METRIC_IPC,
+  METRIC_CACHE_MISSES,
+  METRIC_BRANCH_MISSES,
+  METRIC_LLC_MISSES,
+  METRIC_BYTES_PER_ELEMENT,
+  NUM_METRICS
+} CompareMetric;
+
+static const char *compare_metric_titles[NUM_METRICS] = {
+    "Temps",
+    "Comparaisons",
+    "\xC3\x89"
+    "changes + d\xC3\xA9placements",
+    "Octets d\xC3\xA9plac\xC3\xA9s",
+    "Instructions par cycle",
+    "Cache misses / \xC3\xA9l\xC3\xA9ment",
+    "Branch misses / \xC3\xA9l\xC3\xA9ment",
+    "LLC misses / \xC3\xA9l\xC3\xA9ment",
+    "M\xC3\xA9moire / \xC3\xA9l\xC3\xA9ment (octets)"};
+
+// Ratios get decimals on the y axis
+static gboolean metric_is_ratio(int metric) { return metric >= METRIC_IPC; }
+
+// Per-element miss counts; 0 when the counter was not measured
+static double hw_per_element(const PerformancePoint *p, HwCounter c) {
+  if (!(p->hw_valid & (1u << c)) || p->size == 0)
+    return 0;
+  return (double)p->hw[c] / p->size;
+}
+
+static double perf_point_value(const PerformancePoint *p, int metric) {
+  switch (metric) {
+  case METRIC_COMPARISONS:
+    return (double)p->ops.comparisons;
+  case METRIC_SWAPS_MOVES:
+    return (double)(p->ops.swaps + p->ops.moves);
+  case METRIC_BYTES:
+    return (double)p->ops.bytes_moved;
+  case METRIC_IPC: {
+    unsigned need = (1u << HW_CYCLES) | (1u << HW_INSTRUCTIONS);
+    if ((p->hw_valid & need) != need || p->hw[HW_CYCLES] == 0)
+      return 0;
+    return (double)p->hw[HW_INSTRUCTIONS] / p->hw[HW_CYCLES];
+  }
+  case METRIC_CACHE_MISSES:
+    return hw_per_element(p, HW_CACHE_MISSES);
+  case METRIC_BRANCH_MISSES:
+    return hw_per_element(p, HW_BRANCH_MISSES);
+  case METRIC_LLC_MISSES:
+    return hw_per_element(p, HW_LLC_MISSES);
+  case METRIC_BYTES_PER_ELEMENT:
+    return p->size ? (double)p->mem_bytes / p->size : 0;
+  default:
+    return p->time_ns;
+  }
+}
+
+// --- Complexity fitting ---
+// A curve is fitted as y = c * f(n) for f in n, n log n, n^2 and n^3. The
+// least squares are weighted by 1/y^2, i.e. they minimise the relative
+// error, so small sizes count as much as large ones. The model with the
+// best (weighted) R^2 wins.
+typedef enum {
+  MODEL_N,
+  MODEL_NLOGN,
+  MODEL_N2,
+  MODEL_N3,
+  NUM_MODELS
+} ComplexityModel;
+
+#define FIT_MIN_POINTS 3
+
+static const char *model_keys[NUM_MODELS] = {"n", "nlogn", "n2", "n3"};
+static const char *model_labels[NUM_MODELS] = {"n", "n log n", "n\xC2\xB2",
+                                               "n\xC2\xB3"};
+
+typedef struct {
+  int model;       // ComplexityModel
+  double constant; // In units of the metric: ns per f(n) for time
+  double r2;
+} ComplexityFit;
+
+static double model_eval(int model, double n) {
+  switch (model) {
+  case MODEL_NLOGN:
+    return n * log2(n);
+  case MODEL_N2:
+    return n * n;
+  case MODEL_N3:
+    return n * n * n;
+  default:
+    return n;
+  }
+}
+
+// FALSE with fewer than FIT_MIN_POINTS measured points
+static gboolean fit_model(const PerformancePoint *pts, int count, int metric,
+                          int model, ComplexityFit *fit) {
+  double sfy = 0, sff = 0, sw = 0, swy = 0;
+  int used = 0;
+  for (int i = 0; i < count; i++) {
+    double y = perf_point_value(&pts[i], metric);
+    if (pts[i].runs == 0 || pts[i].size < 2 || y <= 0)
+      continue;
+    double f = model_eval(model, (double)pts[i].size);
+    sfy += f / y; // w * f * y with w = 1 / y^2
+    sff += (f / y) * (f / y);
+    sw += 1 / (y * y);
+    swy += 1 / y;
+    used++;
+  }
+  if (used < FIT_MIN_POINTS || sff == 0)
+    return FALSE;
+
+  double c = sfy / sff, mean = swy / sw, ss_res = 0, ss_tot = 0;
+  for (int i = 0; i < count; i++) {
+    double y = perf_point_value(&pts[i], metric);
+    if (pts[i].runs == 0 || pts[i].size < 2 || y <= 0)
+      continue;
+    double f = model_eval(model, (double)pts[i].size);
+    ss_res += (1 - c * f / y) * (1 - c * f / y);
+    ss_tot += (1 - mean / y) * (1 - mean / y);
+  }
+  fit->model = model;
+  fit->constant = c;
+  fit->r2 = ss_tot > 0 ? 1 - ss_res / ss_tot : (ss_res == 0 ? 1 : 0);
+  return TRUE;
+}
+
+static gboolean fit_complexity(const PerformancePoint *pts, int count,
+                               int metric, ComplexityFit *best) {
+  gboolean found = FALSE;
+  for (int m = 0; m < NUM_MODELS; m++) {
+    ComplexityFit fit;
+    if (fit_model(pts, count, metric, m, &fit) &&
+        (!found || fit.r2 > best->r2)) {
+      *best = fit;
+      found = TRUE;
     }
   }
+  return found;
+}
 
-  int type_idx = app->original_array ? app->original_array->type : DATA_INT;
+// --- Baselines ---
+// A baseline file stores the fitted time model of each benchmarked curve,
+// one line per curve:
+//   structure algo type dist threads model constant r2
+// A later run regresses when its constant, refitted with the stored model,
+// exceeds the stored one by more than the tolerance.
+#define BASELINE_TOLERANCE 0.10
+#define BASELINE_KEY_LEN 96
 
-  // Determine active tab
-  const char *vis =
-      gtk_stack_get_visible_child_name(GTK_STACK(app->view_stack));
-  int is_list_mode = (g_strcmp0(vis, "view_list") == 0);
+typedef struct {
+  char key[BASELINE_KEY_LEN]; // Structure, algo, type, dist and threads
+  ComplexityFit fit;
+} BaselineEntry;
 
-  for (int a = 0; a < num_algos; a++) {
-    ComparisonCurve *curve = g_new0(ComparisonCurve, 1);
-    curve->algo_name = (char *)algo_names[a]; // static string
-    curve->algo_index = algos[a];
-    curve->num_points = num_sizes;
-    curve->points = calloc(num_sizes, sizeof(PerformancePoint));
-
-    for (int s = 0; s < num_sizes; s++) {
-      size_t sz = sizes[s];
-      uint64_t dur = 0;
-
-      // SKIP SLOW ALGORITHMS FOR LARGE SIZES
-      // Algo 0=Bubble, 1=Insertion. They are O(N^2).
-      // 20000^2 = 400M ops. 400ms-1s.
-      // 50000^2 = 2.5B ops. 2.5s-5s.
-      // 100000^2 = 100s. Too long.
-      // Skip if > 20000 for Bubble/Insertion
-      if ((algos[a] == 0 || algos[a] == 1) && sz > 20000) {
-        dur = 0; // 0 means skipped
-      } else {
-        if (is_list_mode) {
-          LinkedList *l = create_linked_list(type_idx, FALSE);
-          fill_linked_list_random(l, sz);
-          dur = sort_list_wrapper(app, l, algos[a]);
-          free_linked_list(l);
-        } else {
-          Array *arr = create_array(type_idx, sz);
-          fill_array_random(arr);
-          dur = sort_array_wrapper(app, arr, algos[a]);
-          free_array(arr);
-        }
-      }
+struct Baseline {
+  BaselineEntry *entries;
+  int count;
+};
+
+static void baseline_key(char *buf, BenchSuite suite,
+                         StructureType structure, int algo, int type, int dist,
+                         int threads) {
+  snprintf(buf, BASELINE_KEY_LEN, "%s %s %s %s %d",
+           bench_structure_key(suite, structure),
+           bench_suites[suite].keys[algo], bench_type_keys[type],
+           dist_keys[dist], threads);
+}
+
+static void baseline_write_header(FILE *f) {
+  fprintf(f, "# structure algo type dist threads model constant r2\n");
+}
+
+static void baseline_write(FILE *f, const char *key,
+                           const ComplexityFit *fit) {
+  fprintf(f, "%s %s %.6e %.6f\n", key, model_keys[fit->model], fit->constant,
+          fit->r2);
+}
+
+static void baseline_free(Baseline *b) {
+  if (!b)
+    return;
+  g_free(b->entries);
+  g_free(b);
+}
 
-      curve->points[s].size = sz;
-      curve->points[s].time_ns = dur;
+// NULL if the file cannot be read or a line is malformed
+static Baseline *baseline_load(const char *path) {
+  FILE *f = fopen(path, "r");
+  if (!f)
+    return NULL;
+  Baseline *b = g_new0(Baseline, 1);
+  int cap = 0;
+  char line[256];
+  gboolean ok = TRUE;
+  while (ok && fgets(line, sizeof(line), f)) {
+    char structure[16], algo[16], type[16], dist[16], model[16];
+    int threads;
+    double constant, r2;
+    if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0')
+      continue;
+    ok = sscanf(line, "%15s %15s %15s %15s %d %15s %lf %lf", structure, algo,
+                type, dist, &threads, model, &constant, &r2) == 8 &&
+         constant > 0;
+    int m = 0;
+    while (ok && m < NUM_MODELS && strcmp(model, model_keys[m]) != 0)
+      m++;
+    if (!ok || m == NUM_MODELS) {
+      ok = FALSE;
+      break;
     }
-    app->comparison_data[a] = curve;
+    if (b->count == cap) {
+      cap = cap ? cap * 2 : 16;
+      b->entries = g_renew(BaselineEntry, b->entries, cap);
+    }
+    BaselineEntry *e = &b->entries[b->count++];
+    snprintf(e->key, sizeof(e->key), "%s %s %s %s %d", structure, algo, type,
+             dist, threads);
+    e->fit.model = m;
+    e->fit.constant = constant;
+    e->fit.r2 = r2;
+  }
+  fclose(f);
+  if (!ok) {
+    baseline_free(b);
+    return NULL;
   }
-  g_free(sizes); // Don't forget to free sizes array generated earlier
+  return b;
+}
 
-  if (app->compare_window)
-    gtk_widget_queue_draw(
-        gtk_bin_get_child(GTK_BIN(app->compare_window))); // Redraw drawing area
-  app->is_benchmarking = FALSE;
+static const BaselineEntry *baseline_find(const Baseline *b, const char *key) {
+  for (int i = 0; b && i < b->count; i++)
+    if (strcmp(b->entries[i].key, key) == 0)
+      return &b->entries[i];
+  return NULL;
+}
+
+// Current constant over the baseline's, both under the baseline's model;
+// FALSE when the curve has too few points to be fitted
+static gboolean baseline_ratio(const BaselineEntry *e,
+                               const PerformancePoint *pts, int count,
+                               double *ratio) {
+  ComplexityFit now;
+  if (!fit_model(pts, count, METRIC_TIME, e->fit.model, &now))
+    return FALSE;
+  *ratio = now.constant / e->fit.constant;
+  return TRUE;
 }
 
 static void render_performance_graph(cairo_t *cr, double W, double H,
@@ -3583,7 +8414,8 @@ static void render_performance_graph(cairo_t *cr, double W, double H,
   }
   cairo_paint(cr);
 
-  if (!app || !app->comparison_data[0]) {
+  if (!app || !app->comparison_data[0] ||
+      app->comparison_data[0]->num_points == 0) {
     cairo_set_source_rgb(cr, 0.5, 0.5, 0.5);
     cairo_set_font_size(cr, 20 * f);
     cairo_move_to(cr, W / 2 - 100 * f, H / 2);
@@ -3600,24 +8432,41 @@ static void render_performance_graph(cairo_t *cr, double W, double H,
   cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL,
                          CAIRO_FONT_WEIGHT_BOLD);
   cairo_set_font_size(cr, 22 * f);
-  const char *title = "ANALYSE DES PERFORMANCES";
+  char title[96];
+  if (app->comparison_suite == SUITE_SORT)
+    snprintf(title, sizeof(title), "ANALYSE DES PERFORMANCES (%s)",
+             dist_labels[app->comparison_dist % NUM_DISTS]);
+  else if (app->comparison_suite == SUITE_GRAPH) // Inputs ignore the shape
+    snprintf(title, sizeof(title), "%s",
+             bench_suites[app->comparison_suite].title);
+  else
+    snprintf(title, sizeof(title), "%s (%s)",
+             bench_suites[app->comparison_suite].title,
+             dist_labels[app->comparison_dist % NUM_DISTS]);
   cairo_text_extents_t te;
   cairo_text_extents(cr, title, &te);
   cairo_move_to(cr, (W - te.width) / 2, 45 * f);
   cairo_show_text(cr, title);
 
   // Find maxes
+  int metric = app->compare_metric;
   double max_time = 0, max_size = 0;
   for (int i = 0; i < app->num_curves; i++) {
     if (!app->comparison_data[i])
       continue;
     for (int j = 0; j < app->comparison_data[i]->num_points; j++) {
-      if ((double)app->comparison_data[i]->points[j].time_ns > max_time)
-        max_time = (double)app->comparison_data[i]->points[j].time_ns;
+      double v = perf_point_value(&app->comparison_data[i]->points[j], metric);
+      if (metric == METRIC_TIME)
+        v = MAX(v, app->comparison_data[i]->points[j].time_p95);
+      if (v > max_time)
+        max_time = v;
       if ((double)app->comparison_data[i]->points[j].size > max_size)
         max_size = (double)app->comparison_data[i]->points[j].size;
     }
   }
+  // Fixed x axis while points stream in
+  if (app->test_sizes && app->num_sizes > 0)
+    max_size = (double)app->test_sizes[app->num_sizes - 1];
   if (max_time == 0)
     max_time = 1;
   if (max_size == 0)
@@ -3636,13 +8485,17 @@ static void render_performance_graph(cairo_t *cr, double W, double H,
     cairo_stroke(cr);
   }
 
-  const char *compl[] = {"O(n\xC2\xB2)", "O(n\xC2\xB2)", "O(n log\xC2\xB2 n)",
-                         "O(n log n)"};
-  double colors[4][3] = {
+  // Indexed by algo_index so a curve keeps its color whatever the subset
+  const char *const *compl = bench_suites[app->comparison_suite].complexity;
+  double colors[NUM_SORT_ALGOS][3] = {
       {0.91, 0.30, 0.24}, // Soft Red (Bubble)
       {0.95, 0.77, 0.06}, // Soft Amber (Insertion)
       {0.48, 0.36, 1.00}, // Sapphire (Shell)
-      {0.00, 0.82, 0.70}  // Teal (Quick)
+      {0.00, 0.82, 0.70}, // Teal (Quick)
+      {0.90, 0.35, 0.75}, // Orchid (Intro)
+      {0.20, 0.60, 0.95}, // Sky Blue (Radix)
+      {0.55, 0.85, 0.25}, // Lime (Parallel)
+      {1.00, 0.55, 0.15}  // Tangerine (Tim)
   };
 
   // --- Curves ---
@@ -3650,13 +8503,14 @@ static void render_performance_graph(cairo_t *cr, double W, double H,
     if (!app->comparison_data[i])
       continue;
 
+    int c = app->comparison_data[i]->algo_index % NUM_SORT_ALGOS;
+
     // Area
-    cairo_set_source_rgba(cr, colors[i % 4][0], colors[i % 4][1],
-                          colors[i % 4][2], 0.15);
+    cairo_set_source_rgba(cr, colors[c][0], colors[c][1], colors[c][2], 0.15);
     int first = 1;
     double lx = PAD;
     for (int j = 0; j < app->comparison_data[i]->num_points; j++) {
-      double t = (double)app->comparison_data[i]->points[j].time_ns;
+      double t = perf_point_value(&app->comparison_data[i]->points[j], metric);
       double sz = (double)app->comparison_data[i]->points[j].size;
       double x = PAD + (sz / max_size) * (W - 2 * PAD);
       double y = (H - PAD) - (t / max_time) * (H - 2 * PAD);
@@ -3673,13 +8527,42 @@ static void render_performance_graph(cairo_t *cr, double W, double H,
     cairo_close_path(cr);
     cairo_fill(cr);
 
+    // Error band: min to p95 of the timed runs around the median line
+    if (metric == METRIC_TIME) {
+      PerformancePoint *pts = app->comparison_data[i]->points;
+      int np = app->comparison_data[i]->num_points;
+      int drawn = 0;
+      for (int j = 0; j < np; j++) {
+        if (pts[j].runs < 2)
+          continue;
+        double x = PAD + ((double)pts[j].size / max_size) * (W - 2 * PAD);
+        double y = (H - PAD) - (pts[j].time_p95 / max_time) * (H - 2 * PAD);
+        if (drawn++ == 0)
+          cairo_move_to(cr, x, y);
+        else
+          cairo_line_to(cr, x, y);
+      }
+      for (int j = np - 1; j >= 0; j--) {
+        if (pts[j].runs < 2)
+          continue;
+        double x = PAD + ((double)pts[j].size / max_size) * (W - 2 * PAD);
+        double y = (H - PAD) - (pts[j].time_min / max_time) * (H - 2 * PAD);
+        cairo_line_to(cr, x, y);
+      }
+      if (drawn > 0) {
+        cairo_close_path(cr);
+        cairo_set_source_rgba(cr, colors[c][0], colors[c][1], colors[c][2],
+                              0.35);
+        cairo_fill(cr);
+      }
+    }
+
     // Line
-    cairo_set_source_rgb(cr, colors[i % 4][0], colors[i % 4][1],
-                         colors[i % 4][2]);
+    cairo_set_source_rgb(cr, colors[c][0], colors[c][1], colors[c][2]);
     cairo_set_line_width(cr, 3.5 * f);
     first = 1;
     for (int j = 0; j < app->comparison_data[i]->num_points; j++) {
-      double t = (double)app->comparison_data[i]->points[j].time_ns;
+      double t = perf_point_value(&app->comparison_data[i]->points[j], metric);
       if (t == 0 && j > 0)
         continue;
       double sz = (double)app->comparison_data[i]->points[j].size;
@@ -3697,12 +8580,13 @@ static void render_performance_graph(cairo_t *cr, double W, double H,
 
   // --- Legend ---
   cairo_set_font_size(cr, 14 * f);
+  int row = 0; // Curves the structure lacks leave no gap
   for (int i = 0; i < app->num_curves; i++) {
     if (!app->comparison_data[i])
       continue;
-    double leg_x = W - 220 * f, leg_y = PAD + 20 * f + i * 28 * f;
-    cairo_set_source_rgb(cr, colors[i % 4][0], colors[i % 4][1],
-                         colors[i % 4][2]);
+    int c = app->comparison_data[i]->algo_index % NUM_SORT_ALGOS;
+    double leg_x = W - 260 * f, leg_y = PAD + 20 * f + (row++) * 40 * f;
+    cairo_set_source_rgb(cr, colors[c][0], colors[c][1], colors[c][2]);
     cairo_rectangle(cr, leg_x, leg_y, 14 * f, 14 * f);
     cairo_fill(cr);
 
@@ -3714,8 +8598,37 @@ static void render_performance_graph(cairo_t *cr, double W, double H,
     cairo_move_to(cr, leg_x + 25 * f, leg_y + 12 * f);
     char buf[128];
     snprintf(buf, sizeof(buf), "%s : %s", app->comparison_data[i]->algo_name,
-             compl[i % 4]);
+             compl[c]);
     cairo_show_text(cr, buf);
+
+    // Fitted model under the name; against the baseline in time mode
+    ComparisonCurve *curve = app->comparison_data[i];
+    ComplexityFit fit;
+    if (metric_is_ratio(metric) ||
+        !fit_complexity(curve->points, curve->num_points, metric, &fit))
+      continue;
+    int len = snprintf(buf, sizeof(buf), "%.3g \xC2\xB7 %s  (R\xC2\xB2 %.3f)",
+                       fit.constant, model_labels[fit.model], fit.r2);
+    char key[BASELINE_KEY_LEN];
+    baseline_key(key, app->comparison_suite, app->comparison_structure,
+                 curve->algo_index, app->comparison_type, app->comparison_dist,
+                 bench_op_threaded(app->comparison_suite, curve->algo_index)
+                     ? app->comparison_threads
+                     : 1);
+    const BaselineEntry *base = baseline_find(app->baseline, key);
+    double ratio;
+    gboolean regressed = FALSE;
+    if (metric == METRIC_TIME && base &&
+        baseline_ratio(base, curve->points, curve->num_points, &ratio)) {
+      snprintf(buf + len, sizeof(buf) - len, "  \xC3\x97%.2f", ratio);
+      regressed = ratio > 1 + BASELINE_TOLERANCE;
+    }
+    cairo_set_font_size(cr, 11 * f);
+    if (regressed)
+      cairo_set_source_rgb(cr, 0.9, 0.2, 0.2);
+    cairo_move_to(cr, leg_x + 25 * f, leg_y + 27 * f);
+    cairo_show_text(cr, buf);
+    cairo_set_font_size(cr, 14 * f);
   }
 
   // --- Axis labels ---
@@ -3738,7 +8651,11 @@ static void render_performance_graph(cairo_t *cr, double W, double H,
     double val_y = max_time * i / 5.0;
     double y = (H - PAD) - i * (H - 2 * PAD) / 5.0;
     char by[32];
-    if (val_y >= 1000000)
+    if (metric_is_ratio(metric))
+      snprintf(by, 32, "%.2f", val_y);
+    else if (metric != METRIC_TIME)
+      format_count(by, sizeof(by), (uint64_t)val_y);
+    else if (val_y >= 1000000)
       snprintf(by, 32, "%.1f ms", val_y / 1000000.0);
     else
       snprintf(by, 32, "%.0f ns", val_y);
@@ -3755,9 +8672,21 @@ static void render_performance_graph(cairo_t *cr, double W, double H,
   cairo_set_font_size(cr, 15 * f);
   cairo_move_to(cr, W / 2 - 40 * f, H - 15 * f);
   cairo_show_text(cr, "Taille (n)");
+
+  cairo_move_to(cr, PAD - 75 * f, PAD - 15 * f);
+  cairo_show_text(cr, compare_metric_titles[metric % NUM_METRICS]);
+}
+
+// Combo ids are CompareMetric values: rows depend on the build
+static void on_compare_metric_changed(GtkComboBox *combo, gpointer user_data) {
+  AppData *app = (AppData *)user_data;
+  const char *id = gtk_combo_box_get_active_id(combo);
+  app->compare_metric = id ? atoi(id) : METRIC_TIME;
+  gtk_widget_queue_draw(app->comparison_canvas);
 }
 
 gboolean on_draw_compare(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
+  PROF_SCOPE("on_draw_compare");
   AppData *app = (AppData *)user_data;
   double W = gtk_widget_get_allocated_width(widget);
   double H = gtk_widget_get_allocated_height(widget);
@@ -3771,6 +8700,7 @@ gboolean on_draw_compare(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
 
 // Helper to set markup safely
 void set_buffer_markup(GtkTextBuffer *buffer, const char *markup) {
+  PROF_SCOPE("set_buffer_markup");
   if (!buffer)
     return;
   gtk_text_buffer_set_text(buffer, "", -1);
@@ -3939,7 +8869,8 @@ void on_generate_array(GtkWidget *widget, gpointer user_data) {
     if (app->original_array)
       free_array(app->original_array);
     app->original_array = create_array(type_idx, sz);
-    fill_array_random(app->original_array);
+    fill_array_dist(app->original_array, get_dist_combo(app->array_dist_combo),
+                    &app->rng);
     set_status(
         app, "Tableau g\xC3\xA9n\xC3\xA9r\xC3\xA9 (%zu \xC3\xA9l\xC3\xA9ments)",
         sz);
@@ -3965,6 +8896,13 @@ void on_generate_array(GtkWidget *widget, gpointer user_data) {
 
 // ... Sort Array unchanged ...
 
+// Offers the list merge sort only for a list it can relink
+static void update_list_merge_button(AppData *app) {
+  gtk_widget_set_sensitive(
+      app->btn_list_merge,
+      !app->current_list || list_kind_merge_sortable(app->current_list->kind));
+}
+
 void on_generate_list(GtkWidget *widget, gpointer user_data) {
   AppData *app = (AppData *)user_data;
   int mode = gtk_combo_box_get_active(GTK_COMBO_BOX(app->list_mode_combo));
@@ -3982,14 +8920,11 @@ void on_generate_list(GtkWidget *widget, gpointer user_data) {
     if (sz <= 0)
       sz = 10;
 
-    int is_double =
-        gtk_combo_box_get_active(GTK_COMBO_BOX(app->list_type_combo)) ==
-        1; // 0=Simple, 1=Double
-
     if (app->current_list)
       free_linked_list(app->current_list);
-    app->current_list = create_linked_list(type_idx, is_double);
-    fill_linked_list_random(app->current_list, sz);
+    app->current_list = create_list(type_idx, app_list_kind(app));
+    fill_linked_list_dist(app->current_list, sz,
+                          get_dist_combo(app->list_dist_combo), &app->rng);
     set_status(app, "Liste g\xC3\xA9n\xC3\xA9r\xC3\xA9\x65");
   }
 
@@ -4013,6 +8948,7 @@ void on_generate_list(GtkWidget *widget, gpointer user_data) {
   }
 
   gtk_widget_queue_draw(app->list_canvas);
+  update_list_merge_button(app);
   update_dashboard_stats(app, 1,
                          app->current_list ? app->current_list->size : 0, -1);
   add_history_entry(
@@ -4023,13 +8959,11 @@ void on_generate_list(GtkWidget *widget, gpointer user_data) {
 // ... Sort List unchanged ...
 
 void on_generate_tree(GtkWidget *widget, gpointer user_data) {
+  PROF_SCOPE("generate_tree");
   AppData *app = (AppData *)user_data;
   int mode = gtk_combo_box_get_active(GTK_COMBO_BOX(app->tree_mode_combo));
 
-  if (app->tree_root) {
-    free_tree((TreeNode *)app->tree_root, app->tree_data_type);
-    app->tree_root = NULL;
-  }
+  app_clear_tree(app);
 
   app->tree_data_type =
       gtk_combo_box_get_active(GTK_COMBO_BOX(app->tree_data_type_combo));
@@ -4108,6 +9042,9 @@ void on_tree_action(GtkWidget *widget, gpointer user_data) {
   g_string_free(out, TRUE);
 }
 
+static void finish_array_sort(AppData *app, uint64_t t,
+                              const SortStats *ops);
+
 void on_sort_array(GtkWidget *widget, gpointer user_data) {
   AppData *app = (AppData *)user_data;
   if (!app->original_array)
@@ -4119,19 +9056,21 @@ void on_sort_array(GtkWidget *widget, gpointer user_data) {
 
   int algo = gtk_combo_box_get_active(GTK_COMBO_BOX(app->algo_selector_combo));
   const char *btn_id = gtk_widget_get_name(widget);
-  double old_speed = app->animation_speed;
 
-  // If clicked on "Trier" (instant), we force speed to 0
-  if (g_strcmp0(btn_id, "btn_sort_animate") != 0) {
-    app->animation_speed = 0;
-  } else {
-    // Open animation window
-    open_animation_window(app);
+  // "Animer": sorts while recording, the window replays the trace
+  SortStats ops;
+  if (g_strcmp0(btn_id, "btn_sort_animate") == 0) {
+    SortTrace *trace = sort_trace_record(app, app->sorted_array, algo, &ops);
+    finish_array_sort(app, trace->elapsed, &ops);
+    open_animation_window(app, trace);
+    return;
   }
+  uint64_t t = sort_array_wrapper(app, app->sorted_array, algo, &ops);
+  finish_array_sort(app, t, &ops);
+}
 
-  uint64_t t = sort_array_wrapper(app, app->sorted_array, algo);
-  app->animation_speed = old_speed;
-
+static void finish_array_sort(AppData *app, uint64_t t,
+                              const SortStats *ops) {
   char *s = array_to_string(app->sorted_array, TRUE, app);
   set_buffer_markup(app->buffer_array_after, s);
   g_free(s);
@@ -4142,6 +9081,7 @@ void on_sort_array(GtkWidget *widget, gpointer user_data) {
              " en %.3f ms",
              ms);
   update_dashboard_stats(app, 0, app->sorted_array->size, ms);
+  update_dashboard_sort_ops(app, 0, ops);
 
   const char *algo_name = gtk_combo_box_text_get_active_text(
       GTK_COMBO_BOX_TEXT(app->algo_selector_combo));
@@ -4149,23 +9089,36 @@ void on_sort_array(GtkWidget *widget, gpointer user_data) {
                                          algo_name ? algo_name : "Inconnu"));
 }
 
+static void finish_list_sort(AppData *app, int algo, uint64_t t,
+                             const SortStats *ops);
+
 void on_sort_list(GtkWidget *widget, gpointer user_data) {
   AppData *app = (AppData *)user_data;
   if (!app->current_list)
     return;
   int algo = gtk_combo_box_get_active(GTK_COMBO_BOX(app->algo_selector_combo));
   const char *btn_id = gtk_widget_get_name(widget);
-  double old_speed = app->animation_speed;
-
-  if (g_strcmp0(btn_id, "btn_list_animate") != 0) {
-    app->animation_speed = 0;
-  } else {
-    open_animation_window(app);
+  if (g_strcmp0(btn_id, "btn_list_merge") == 0)
+    algo = LIST_MERGE_SORT;
+
+  SortStats ops = {0};
+  if (g_strcmp0(btn_id, "btn_list_animate") == 0) {
+    SortTrace *trace = NULL; // Empty list: the window plays the demo
+    if (app->current_list->size > 0) {
+      Array *arr = list_to_array(app->current_list);
+      trace = sort_trace_record(app, arr, algo, &ops);
+      array_to_list(arr, app->current_list);
+    }
+    finish_list_sort(app, algo, trace ? trace->elapsed : 0, &ops);
+    open_animation_window(app, trace);
+    return;
   }
+  uint64_t t = sort_list_wrapper(app, app->current_list, algo, &ops);
+  finish_list_sort(app, algo, t, &ops);
+}
 
-  uint64_t t = sort_list_wrapper(app, app->current_list, algo);
-  app->animation_speed = old_speed;
-
+static void finish_list_sort(AppData *app, int algo, uint64_t t,
+                             const SortStats *ops) {
   // Resize canvas for scrolling
   if (app->current_list) {
     int NODE_W = 70, PAD_X = 35;
@@ -4189,8 +9142,11 @@ void on_sort_list(GtkWidget *widget, gpointer user_data) {
   double ms = t / 1000000.0;
   set_status(app, "Liste tri\xC3\xA9\x65 en %.3f ms", ms);
   update_dashboard_stats(app, 1, app->current_list->size, ms);
-  const char *algo_name = gtk_combo_box_text_get_active_text(
-      GTK_COMBO_BOX_TEXT(app->algo_selector_combo));
+  update_dashboard_sort_ops(app, 1, ops);
+  const char *algo_name = "Tri fusion";
+  if (algo != LIST_MERGE_SORT)
+    algo_name = gtk_combo_box_text_get_active_text(
+        GTK_COMBO_BOX_TEXT(app->algo_selector_combo));
   add_history_entry(app, g_strdup_printf("Tri Liste (%s)",
                                          algo_name ? algo_name : "Inconnu"));
 }
@@ -4218,6 +9174,7 @@ void on_reset_structure(GtkWidget *widget, gpointer user_data) {
     if (app->current_list)
       free_linked_list(app->current_list);
     app->current_list = NULL;
+    update_list_merge_button(app);
     gtk_widget_queue_draw(app->list_canvas);
     // Resize back to default?
     gtk_widget_set_size_request(app->list_canvas, -1, 400);
@@ -4227,9 +9184,7 @@ void on_reset_structure(GtkWidget *widget, gpointer user_data) {
         "S\xC3\xA9lectionnez un algorithme\npour voir son pseudo-code ici.");
     update_dashboard_stats(app, 1, 0, -1);
   } else if (g_strcmp0(id, "reset_tree") == 0) {
-    if (app->tree_root)
-      free_tree((TreeNode *)app->tree_root, app->tree_data_type);
-    app->tree_root = NULL;
+    app_clear_tree(app);
     gtk_widget_queue_draw(app->tree_canvas);
     set_status(app, "Arbre r\xC3\xA9initialis\xC3\xA9");
     set_pseudo_code(
@@ -4277,21 +9232,13 @@ void on_list_action(GtkWidget *widget, gpointer user_data) {
     else if (t == DATA_CHAR)
       *(char *)val_ptr = val[0];
     else if (t == DATA_STRING)
-      *((char **)val_ptr) =
-          g_strdup(val); // will be duplicated again in create_node but that's
-                         // fine or we pass dereferenced
+      *((char **)val_ptr) = (char *)val; // list_insert_value copies it
 
-    // create_node expects pointer to value
+    // list_insert_value expects pointer to value
     // For string, it expects char**
 
-    Node *n = create_node(t, val_ptr);
-
-    // cleanup temp
-    if (t == DATA_STRING)
-      g_free(*(char **)val_ptr);
+    list_insert_value(app->current_list, val_ptr, pos);
     free(val_ptr);
-
-    insert_to_linkedlist(app->current_list, n, pos);
   } else if (op == 1) { // Modify
     modify_linkedlist(app->current_list, pos, val);
   } else if (op == 2) { // Delete
@@ -4320,7 +9267,42 @@ void on_list_action(GtkWidget *widget, gpointer user_data) {
   update_dashboard_stats(app, 1, app->current_list->size, -1);
 }
 
+// Returns the chosen file name (g_free) or NULL. default_name is used when
+// saving; filter is a glob such as "*.dstrace".
+static char *run_file_dialog(AppData *app, GtkWidget *parent,
+                             GtkFileChooserAction action, const char *title,
+                             const char *accept, const char *filter,
+                             const char *filter_name,
+                             const char *default_name) {
+  GtkWidget *dialog = gtk_file_chooser_dialog_new(
+      title, GTK_WINDOW(parent), action, "Annuler", GTK_RESPONSE_CANCEL,
+      accept, GTK_RESPONSE_ACCEPT, NULL);
+  gtk_window_set_modal(GTK_WINDOW(dialog), TRUE);
+  apply_css(dialog, app);
+
+  GtkFileFilter *file_filter = gtk_file_filter_new();
+  gtk_file_filter_add_pattern(file_filter, filter);
+  gtk_file_filter_set_name(file_filter, filter_name);
+  gtk_file_chooser_add_filter(GTK_FILE_CHOOSER(dialog), file_filter);
+
+  const char *desktop_path = g_get_user_special_dir(G_USER_DIRECTORY_DESKTOP);
+  if (desktop_path)
+    gtk_file_chooser_set_current_folder(GTK_FILE_CHOOSER(dialog), desktop_path);
+  if (action == GTK_FILE_CHOOSER_ACTION_SAVE) {
+    gtk_file_chooser_set_do_overwrite_confirmation(GTK_FILE_CHOOSER(dialog),
+                                                   TRUE);
+    gtk_file_chooser_set_current_name(GTK_FILE_CHOOSER(dialog), default_name);
+  }
+
+  char *filename = NULL;
+  if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT)
+    filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dialog));
+  gtk_widget_destroy(dialog);
+  return filename;
+}
+
 void export_comparison_png(GtkWidget *widget, gpointer user_data) {
+  PROF_SCOPE("export_comparison_png");
   AppData *app = (AppData *)user_data;
 
   if (!app->comparison_data[0]) {
@@ -4384,11 +9366,438 @@ void export_comparison_png(GtkWidget *widget, gpointer user_data) {
   gtk_widget_destroy(dialog);
 }
 
-// Helper to open Floating Animation Window
+// Key of a comparison curve in a baseline file
+static void comparison_baseline_key(AppData *app, const ComparisonCurve *curve,
+                                    char *key) {
+  baseline_key(key, app->comparison_suite, app->comparison_structure,
+               curve->algo_index, app->comparison_type, app->comparison_dist,
+               bench_op_threaded(app->comparison_suite, curve->algo_index)
+                   ? app->comparison_threads
+                   : 1);
+}
+
+static void save_comparison_baseline(GtkWidget *widget, gpointer user_data) {
+  AppData *app = (AppData *)user_data;
+  if (!app->comparison_data[0] || app->bench_job) {
+    set_status(app, "Attendez la fin de l'analyse pour enregistrer une "
+                    "r\xC3\xA9\x66\xC3\xA9rence");
+    return;
+  }
+  char *filename = run_file_dialog(
+      app, app->compare_window, GTK_FILE_CHOOSER_ACTION_SAVE,
+      "ENREGISTRER LA R\xC3\x89\x46\xC3\x89RENCE", "Enregistrer",
+      "*.baseline", "R\xC3\xA9\x66\xC3\xA9rences (*.baseline)",
+      "reference.baseline");
+  if (!filename)
+    return;
+  FILE *f = fopen(filename, "w");
+  g_free(filename);
+  if (!f) {
+    set_status(app,
+               "Erreur d'enregistrement de la r\xC3\xA9\x66\xC3\xA9rence");
+    return;
+  }
+  baseline_write_header(f);
+  int written = 0;
+  for (int i = 0; i < app->num_curves; i++) {
+    ComparisonCurve *curve = app->comparison_data[i];
+    ComplexityFit fit;
+    if (!curve ||
+        !fit_complexity(curve->points, curve->num_points, METRIC_TIME, &fit))
+      continue;
+    char key[BASELINE_KEY_LEN];
+    comparison_baseline_key(app, curve, key);
+    baseline_write(f, key, &fit);
+    written++;
+  }
+  fclose(f);
+  set_status(app,
+             "R\xC3\xA9\x66\xC3\xA9rence enregistr\xC3\xA9\x65 (%d courbes)",
+             written);
+}
+
+// The legend then shows each curve's constant against the reference; later
+// benchmarks keep being checked until another file is loaded.
+static void load_comparison_baseline(GtkWidget *widget, gpointer user_data) {
+  AppData *app = (AppData *)user_data;
+  char *filename = run_file_dialog(
+      app, app->compare_window, GTK_FILE_CHOOSER_ACTION_OPEN,
+      "COMPARER \xC3\x80 UNE R\xC3\x89\x46\xC3\x89RENCE", "Comparer",
+      "*.baseline", "R\xC3\xA9\x66\xC3\xA9rences (*.baseline)", NULL);
+  if (!filename)
+    return;
+  Baseline *b = baseline_load(filename);
+  g_free(filename);
+  if (!b) {
+    set_status(app, "Fichier de r\xC3\xA9\x66\xC3\xA9rence invalide");
+    return;
+  }
+  baseline_free(app->baseline);
+  app->baseline = b;
+
+  int checked = 0, regressions = 0;
+  for (int i = 0; i < app->num_curves; i++) {
+    ComparisonCurve *curve = app->comparison_data[i];
+    if (!curve)
+      continue;
+    char key[BASELINE_KEY_LEN];
+    comparison_baseline_key(app, curve, key);
+    const BaselineEntry *e = baseline_find(b, key);
+    double ratio;
+    if (e && baseline_ratio(e, curve->points, curve->num_points, &ratio)) {
+      checked++;
+      if (ratio > 1 + BASELINE_TOLERANCE)
+        regressions++;
+    }
+  }
+  set_status(app,
+             "%d r\xC3\xA9gression(s) sur %d courbe(s) compar\xC3\xA9\x65(s) "
+             "(seuil +%.0f %%)",
+             regressions, checked, BASELINE_TOLERANCE * 100);
+  if (app->comparison_canvas)
+    gtk_widget_queue_draw(app->comparison_canvas);
+}
+
+// --- Animation window: trace replay ---
+
+static const char *anim_algo_names[NUM_SORT_ALGOS] = {
+    "Tri \xC3\xA0 Bulles",
+    "Tri par Insertion",
+    "Tri Shell",
+    "Tri Rapide (QuickSort)",
+    "Tri Introspectif (IntroSort)",
+    "Tri par Base (Radix)",
+    "Tri Parall\xC3\xA8le (Fusion)",
+    "Tri Tim (TimSort)"};
+static const char *anim_algo_desc[NUM_SORT_ALGOS] = {
+    "Principe : On compare les \xC3\xA9l\xC3\xA9ments adjacents 2 \xC3\xA0 "
+    "2. S'ils sont mal ordonn\xC3\xA9s, on les \xC3\xA9"
+    "change. Le plus grand "
+    "'remonte' progressivement comme une bulle.",
+    "Principe : On ins\xC3\xA8re chaque \xC3\xA9l\xC3\xA9ment \xC3\xA0 sa "
+    "place "
+    "dans la partie tri\xC3\xA9\x65, comme on range des cartes \xC3\xA0 "
+    "jouer.",
+    "Principe : Am\xC3\xA9lioration du tri par insertion utilisant un "
+    "ecart qui diminue, permettant des d\xC3\xA9placements rapides.",
+    "Principe : Utilise un pivot pour diviser le tableau en deux parties "
+    "(plus petits / plus grands) et r\xC3\xA9"
+    "curse.",
+    "Principe : Tri rapide avec pivot m\xC3\xA9"
+    "dian, partition en trois (<, =, >) pour les doublons, tri par "
+    "insertion sur les petites parties et repli sur le tri par tas si la "
+    "r\xC3\xA9"
+    "cursion devient trop profonde.",
+    "Principe : Aucune comparaison. On r\xC3\xA9partit les valeurs "
+    "chiffre par chiffre (du moins au plus significatif) dans des "
+    "compartiments, ce qui donne un tri en temps lin\xC3\xA9\x61ire.",
+    "Principe : Tri fusion dont les moiti\xC3\xA9s sont tri\xC3\xA9\x65s "
+    "en parall\xC3\xA8le sur tous les c\xC5\x93urs. Un thread inactif "
+    "vole le travail en attente des autres (work-stealing).",
+    "Principe : Tri fusion adaptatif et stable. On rep\xC3\xA8re les "
+    "s\xC3\xA9quences d\xC3\xA9j\xC3\xA0 tri\xC3\xA9\x65s, on allonge les "
+    "plus courtes par insertion, puis on les fusionne en \"galopant\" "
+    "quand un c\xC3\xB4t\xC3\xA9 l'emporte souvent : presque "
+    "lin\xC3\xA9\x61ire sur des donn\xC3\xA9\x65s presque tri\xC3\xA9\x65s."};
+
+// The values are kept every key_every events, so a jump anywhere costs one
+// copy plus at most key_every events; together the keyframes take no more
+// memory than the events themselves.
+struct TracePlayer {
+  AppData *app;
+  SortTrace *trace;
+  uint32_t *values; // Codes after the first pos events
+  size_t pos;
+  size_t key_every;
+  GPtrArray *keyframes; // Values after k * key_every events
+  uint32_t *ranks;      // DATA_STRING: sorted position of each string code
+  double lo, hi;        // Value range, for bar heights
+  int direction;        // 1 playing, -1 rewinding, 0 paused
+  double rate;          // Events per second
+  double budget;        // Fractional events carried over to the next frame
+  guint timer;
+  gboolean syncing; // Scrub bar moved by the player itself
+  GtkWidget *lbl_title;
+  GtkWidget *lbl_princ;
+  GtkWidget *scrub;
+  GtkWidget *lbl_pos;
+  GtkWidget *btn_play;
+};
+
+static void trace_apply(uint32_t *values, const TraceEvent *ev) {
+  if (ev->op == TRACE_SWAP) {
+    uint32_t t = values[ev->i];
+    values[ev->i] = values[ev->a];
+    values[ev->a] = t;
+  } else if (ev->op == TRACE_WRITE) {
+    values[ev->i] = ev->a;
+  }
+}
+
+static void trace_undo(uint32_t *values, const TraceEvent *ev) {
+  if (ev->op == TRACE_WRITE)
+    values[ev->i] = ev->b;
+  else
+    trace_apply(values, ev); // Swaps undo themselves
+}
+
+static double trace_player_value(const TracePlayer *p, uint32_t code) {
+  float f;
+  switch (p->trace->type) {
+  case DATA_INT:
+    return (int32_t)code;
+  case DATA_FLOAT:
+    memcpy(&f, &code, sizeof(f));
+    return f;
+  case DATA_CHAR:
+    return code;
+  case DATA_STRING:
+    return p->ranks[code];
+  }
+  return 0;
+}
+
+// Replays the whole trace once to lay down the keyframes. The final state
+// is the sorted order, which gives the rank of every string.
+static void trace_player_build(TracePlayer *p) {
+  SortTrace *tr = p->trace;
+  size_t bytes = tr->n * sizeof(uint32_t);
+  uint32_t *cur = g_malloc(bytes);
+  memcpy(cur, tr->initial, bytes);
+  p->key_every = MAX(1024, tr->n);
+  p->keyframes = g_ptr_array_new_with_free_func(g_free);
+  for (size_t k = 0; k <= tr->count; k++) {
+    if (k % p->key_every == 0) {
+      uint32_t *key = g_malloc(bytes);
+      memcpy(key, cur, bytes);
+      g_ptr_array_add(p->keyframes, key);
+    }
+    if (k < tr->count)
+      trace_apply(cur, &tr->events[k]);
+  }
+
+  if (tr->type == DATA_STRING) {
+    p->ranks = g_new0(uint32_t, tr->n);
+    for (uint32_t k = 0; k < tr->n; k++) {
+      gboolean same = k > 0 && g_strcmp0(tr->strings[cur[k]],
+                                         tr->strings[cur[k - 1]]) == 0;
+      p->ranks[cur[k]] = same ? p->ranks[cur[k - 1]] : k;
+    }
+  }
+  p->lo = INFINITY;
+  p->hi = -INFINITY;
+  for (uint32_t k = 0; k < tr->n; k++) {
+    double v = trace_player_value(p, cur[k]);
+    if (isfinite(v)) {
+      p->lo = MIN(p->lo, v);
+      p->hi = MAX(p->hi, v);
+    }
+  }
+  if (p->lo > p->hi)
+    p->lo = p->hi = 0;
+  if (p->hi == p->lo)
+    p->hi = p->lo + 1;
+  g_free(cur);
+
+  p->values = g_malloc(bytes);
+  memcpy(p->values, tr->initial, bytes);
+  p->pos = 0;
+}
+
+static void trace_player_seek(TracePlayer *p, size_t target) {
+  SortTrace *tr = p->trace;
+  if (target > tr->count)
+    target = tr->count;
+  if (target + p->key_every < p->pos || target > p->pos + p->key_every) {
+    size_t k = target / p->key_every;
+    memcpy(p->values, g_ptr_array_index(p->keyframes, k),
+           tr->n * sizeof(uint32_t));
+    p->pos = k * p->key_every;
+  }
+  while (p->pos < target)
+    trace_apply(p->values, &tr->events[p->pos++]);
+  while (p->pos > target)
+    trace_undo(p->values, &tr->events[--p->pos]);
+}
+
+static void trace_player_show(TracePlayer *p) {
+  AppData *app = p->app;
+  SortTrace *tr = p->trace;
+  int line = p->pos ? tr->events[p->pos - 1].line : -1;
+  if (line != app->current_pseudo_line)
+    show_pseudo_line(app, line);
+
+  p->syncing = TRUE;
+  gtk_range_set_value(GTK_RANGE(p->scrub), p->pos);
+  p->syncing = FALSE;
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%zu / %zu", p->pos, tr->count);
+  gtk_label_set_text(GTK_LABEL(p->lbl_pos), buf);
+  gtk_button_set_label(GTK_BUTTON(p->btn_play),
+                       p->direction > 0 ? "Pause" : "Lecture");
+  gtk_widget_queue_draw(app->anim_canvas);
+}
+
+static gboolean trace_player_tick(gpointer user_data) {
+  TracePlayer *p = user_data;
+  p->budget += p->rate / ANIM_FPS;
+  size_t steps = (size_t)p->budget;
+  p->budget -= steps;
+  if (steps == 0)
+    return G_SOURCE_CONTINUE;
+
+  if (p->direction > 0)
+    trace_player_seek(p, p->pos + MIN(steps, p->trace->count - p->pos));
+  else
+    trace_player_seek(p, p->pos > steps ? p->pos - steps : 0);
+  gboolean ended = p->direction > 0 ? p->pos == p->trace->count : p->pos == 0;
+  if (ended) {
+    p->direction = 0;
+    p->timer = 0;
+  }
+  trace_player_show(p);
+  return ended ? G_SOURCE_REMOVE : G_SOURCE_CONTINUE;
+}
+
+// direction: 1 forwards, -1 backwards, 0 pause
+static void trace_player_play(TracePlayer *p, int direction) {
+  if (direction > 0 && p->pos == p->trace->count)
+    trace_player_seek(p, 0); // Replay from the start
+  p->direction = direction;
+  p->budget = 0;
+  if (direction && !p->timer)
+    p->timer = g_timeout_add(1000 / ANIM_FPS, trace_player_tick, p);
+  else if (!direction && p->timer) {
+    g_source_remove(p->timer);
+    p->timer = 0;
+  }
+  trace_player_show(p);
+}
+
+static void trace_player_clear(TracePlayer *p) {
+  if (p->keyframes)
+    g_ptr_array_free(p->keyframes, TRUE);
+  g_free(p->values);
+  g_free(p->ranks);
+  sort_trace_free(p->trace);
+  p->keyframes = NULL;
+  p->values = NULL;
+  p->ranks = NULL;
+  p->trace = NULL;
+}
+
+// Takes ownership of trace
+static void trace_player_set_trace(TracePlayer *p, SortTrace *trace) {
+  AppData *app = p->app;
+  trace_player_play(p, 0);
+  trace_player_clear(p);
+  p->trace = trace;
+  trace_player_build(p);
+
+  char title_markup[256];
+  snprintf(
+      title_markup, 256,
+      "<span size='xx-large' weight='heavy' foreground='#D600B2'>%s</span>",
+      anim_algo_names[trace->algo]);
+  gtk_label_set_markup(GTK_LABEL(p->lbl_title), title_markup);
+  gtk_label_set_text(GTK_LABEL(p->lbl_princ), anim_algo_desc[trace->algo]);
+  show_pseudo_code(app, trace->code);
+  gtk_range_set_range(GTK_RANGE(p->scrub), 0, MAX(trace->count, 1));
+  trace_player_show(p);
+}
+
+static void on_trace_first(GtkWidget *widget, gpointer user_data) {
+  TracePlayer *p = user_data;
+  trace_player_play(p, 0);
+  trace_player_seek(p, 0);
+  trace_player_show(p);
+}
+
+static void on_trace_step_back(GtkWidget *widget, gpointer user_data) {
+  TracePlayer *p = user_data;
+  trace_player_play(p, 0);
+  if (p->pos > 0)
+    trace_player_seek(p, p->pos - 1);
+  trace_player_show(p);
+}
+
+static void on_trace_rewind(GtkWidget *widget, gpointer user_data) {
+  trace_player_play(user_data, -1);
+}
+
+static void on_trace_play(GtkWidget *widget, gpointer user_data) {
+  TracePlayer *p = user_data;
+  trace_player_play(p, p->direction > 0 ? 0 : 1);
+}
+
+static void on_trace_step(GtkWidget *widget, gpointer user_data) {
+  TracePlayer *p = user_data;
+  trace_player_play(p, 0);
+  trace_player_seek(p, p->pos + 1);
+  trace_player_show(p);
+}
+
+static void on_trace_last(GtkWidget *widget, gpointer user_data) {
+  TracePlayer *p = user_data;
+  trace_player_play(p, 0);
+  trace_player_seek(p, p->trace->count);
+  trace_player_show(p);
+}
+
+static void on_trace_scrub(GtkRange *range, gpointer user_data) {
+  TracePlayer *p = user_data;
+  if (p->syncing)
+    return;
+  trace_player_seek(p, (size_t)gtk_range_get_value(range));
+  trace_player_show(p);
+}
+
+// Logarithmic: 1 to 10000 events per second
+static void on_trace_speed(GtkRange *range, gpointer user_data) {
+  TracePlayer *p = user_data;
+  p->rate = pow(10, gtk_range_get_value(range) / 25.0);
+}
+
+static void on_trace_save(GtkWidget *widget, gpointer user_data) {
+  TracePlayer *p = user_data;
+  char *filename = run_file_dialog(
+      p->app, p->app->anim_win, GTK_FILE_CHOOSER_ACTION_SAVE,
+      "ENREGISTRER LA TRACE", "Enregistrer", "*.dstrace",
+      "Traces de tri (*.dstrace)", "trace_tri.dstrace");
+  if (!filename)
+    return;
+  if (sort_trace_save(p->trace, filename))
+    set_status(p->app, "Trace enregistr\xC3\xA9\x65 (%zu \xC3\xA9tapes)",
+               p->trace->count);
+  else
+    set_status(p->app, "Erreur d'enregistrement de la trace");
+  g_free(filename);
+}
+
+static void on_trace_load(GtkWidget *widget, gpointer user_data) {
+  TracePlayer *p = user_data;
+  char *filename = run_file_dialog(
+      p->app, p->app->anim_win, GTK_FILE_CHOOSER_ACTION_OPEN,
+      "CHARGER UNE TRACE", "Charger", "*.dstrace",
+      "Traces de tri (*.dstrace)", NULL);
+  if (!filename)
+    return;
+  SortTrace *trace = sort_trace_load(filename);
+  g_free(filename);
+  if (!trace) {
+    set_status(p->app, "Fichier de trace invalide");
+    return;
+  }
+  trace_player_set_trace(p, trace);
+  trace_player_play(p, 1);
+}
+
 static gboolean on_draw_anim_canvas(GtkWidget *widget, cairo_t *cr,
                                     gpointer user_data) {
+  PROF_SCOPE("on_draw_anim_canvas");
   AppData *app = (AppData *)user_data;
-  if (!app->demo_array)
+  TracePlayer *p = app->player;
+  if (!p || !p->trace || p->trace->n == 0)
     return FALSE;
 
   int width = gtk_widget_get_allocated_width(widget);
@@ -4402,45 +9811,105 @@ static gboolean on_draw_anim_canvas(GtkWidget *widget, cairo_t *cr,
   }
   cairo_paint(cr);
 
-  int n = app->demo_array->size;
+  SortTrace *tr = p->trace;
+  int n = tr->n;
   double pad = 40;
   double bar_space = (width - 2 * pad) / n;
-  double bar_w = bar_space * 0.7;
+  double bar_w = bar_space >= 4 ? bar_space * 0.7 : bar_space;
+  double font_size = MIN(22, bar_space * 0.4);
+  // Slots of the last event: amber when compared, red when moved
+  const TraceEvent *ev = p->pos ? &tr->events[p->pos - 1] : NULL;
 
   for (int i = 0; i < n; i++) {
-    int val = ((int *)app->demo_array->data)[i];
-    double bar_h = (double)val / 20.0 * (height - 100);
+    uint32_t code = p->values[i];
+    double norm = (trace_player_value(p, code) - p->lo) / (p->hi - p->lo);
+    if (!isfinite(norm))
+      norm = 0;
+    double bar_h = (0.08 + 0.92 * CLAMP(norm, 0, 1)) * (height - 100);
     double x = pad + i * bar_space + (bar_space - bar_w) / 2.0;
     double y = height - bar_h - 60;
 
+    gboolean touched = ev && ev->op != TRACE_LINE &&
+                       (ev->i == (uint32_t)i ||
+                        (ev->op != TRACE_WRITE && ev->a == (uint32_t)i));
+
     // Bar with gradient (Saphir Premium)
     cairo_pattern_t *pat = cairo_pattern_create_linear(x, y, x, y + bar_h);
-    cairo_pattern_add_color_stop_rgb(pat, 0, 0.48, 0.36, 1.0); // Saphir
-    cairo_pattern_add_color_stop_rgb(pat, 1, 0.15, 0.1, 0.4);  // Deep Blue
+    if (touched && ev->op == TRACE_COMPARE) {
+      cairo_pattern_add_color_stop_rgb(pat, 0, 1.0, 0.72, 0.1); // Amber
+      cairo_pattern_add_color_stop_rgb(pat, 1, 0.5, 0.3, 0.0);
+    } else if (touched) {
+      cairo_pattern_add_color_stop_rgb(pat, 0, 0.95, 0.25, 0.3); // Red
+      cairo_pattern_add_color_stop_rgb(pat, 1, 0.4, 0.05, 0.1);
+    } else {
+      cairo_pattern_add_color_stop_rgb(pat, 0, 0.48, 0.36, 1.0); // Saphir
+      cairo_pattern_add_color_stop_rgb(pat, 1, 0.15, 0.1, 0.4);  // Deep Blue
+    }
     cairo_set_source(cr, pat);
     cairo_rectangle(cr, x, y, bar_w, bar_h);
     cairo_fill(cr);
     cairo_pattern_destroy(pat);
 
-    // Border
+    // Border and text only while bars are wide enough to carry them
+    if (bar_space < 8)
+      continue;
     cairo_set_source_rgb(cr, 1, 1, 1);
     cairo_set_line_width(cr, 1.5);
     cairo_rectangle(cr, x, y, bar_w, bar_h);
     cairo_stroke(cr);
+    if (font_size < 8)
+      continue;
 
-    // Text
-    char buf[12];
-    snprintf(buf, 12, "%d", val);
+    char buf[16];
+    switch (tr->type) {
+    case DATA_INT:
+      snprintf(buf, sizeof(buf), "%d", (int32_t)code);
+      break;
+    case DATA_FLOAT:
+      snprintf(buf, sizeof(buf), "%.1f", trace_player_value(p, code));
+      break;
+    case DATA_CHAR:
+      snprintf(buf, sizeof(buf), "%c", (char)code);
+      break;
+    case DATA_STRING:
+      snprintf(buf, sizeof(buf), "%.3s",
+               tr->strings[code] ? tr->strings[code] : "");
+      break;
+    }
+    cairo_text_extents_t ext;
     cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL,
                            CAIRO_FONT_WEIGHT_BOLD);
-    cairo_set_font_size(cr, 22);
-    cairo_move_to(cr, x + (bar_w / 2.0) - 10, height - 20);
+    cairo_set_font_size(cr, font_size);
+    cairo_text_extents(cr, buf, &ext);
+    cairo_move_to(cr, x + (bar_w - ext.width) / 2.0 - ext.x_bearing,
+                  height - 20);
     cairo_show_text(cr, buf);
   }
   return FALSE;
 }
 
-static void open_animation_window(AppData *app) {
+static GtkWidget *add_trace_button(GtkWidget *box, const char *label,
+                                   GCallback cb, TracePlayer *p) {
+  GtkWidget *btn = gtk_button_new_with_label(label);
+  g_signal_connect(btn, "clicked", cb, p);
+  gtk_box_pack_start(GTK_BOX(box), btn, FALSE, FALSE, 0);
+  return btn;
+}
+
+// Takes ownership of trace; NULL records the demo with the selected algo.
+static void open_animation_window(AppData *app, SortTrace *trace) {
+  app->is_benchmarking = FALSE;
+  if (!trace) {
+    // 12 elements for a readable visualization
+    int demo_init[] = {15, 3, 11, 7, 19, 2, 14, 8, 1, 12, 6, 17};
+    Array *demo = create_array(DATA_INT, G_N_ELEMENTS(demo_init));
+    memcpy(demo->data, demo_init, sizeof(demo_init));
+    int algo_idx =
+        gtk_combo_box_get_active(GTK_COMBO_BOX(app->algo_selector_combo));
+    trace = sort_trace_record(app, demo, algo_idx, NULL);
+    free_array(demo);
+  }
+
   // 1. Create Window
   app->anim_win = gtk_window_new(GTK_WINDOW_TOPLEVEL);
   gtk_window_set_title(GTK_WINDOW(app->anim_win),
@@ -4450,6 +9919,13 @@ static void open_animation_window(AppData *app) {
                                GTK_WINDOW(app->window));
   gtk_window_set_modal(GTK_WINDOW(app->anim_win), TRUE);
 
+  TracePlayer *p = g_new0(TracePlayer, 1);
+  p->app = app;
+  double speed =
+      app->animation_speed > 0 ? app->animation_speed : ANIM_DEFAULT_SPEED;
+  p->rate = 1000.0 / (speed * ANIM_STEP_MS);
+  app->player = p;
+
   GtkWidget *main_hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 20);
   gtk_container_add(GTK_CONTAINER(app->anim_win), main_hbox);
   gtk_container_set_border_width(GTK_CONTAINER(main_hbox), 20);
@@ -4458,38 +9934,13 @@ static void open_animation_window(AppData *app) {
   GtkWidget *left_vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 15);
   gtk_box_pack_start(GTK_BOX(main_hbox), left_vbox, TRUE, TRUE, 0);
 
-  int algo_idx =
-      gtk_combo_box_get_active(GTK_COMBO_BOX(app->algo_selector_combo));
-  const char *algo_names[] = {"Tri \xC3\xA0 Bulles", "Tri par Insertion",
-                              "Tri Shell", "Tri Rapide (QuickSort)"};
-  const char *algo_desc[] = {
-      "Principe : On compare les \xC3\xA9l\xC3\xA9ments adjacents 2 \xC3\xA0 "
-      "2. S'ils sont mal ordonn\xC3\xA9s, on les \xC3\xA9"
-      "change. Le plus grand "
-      "'remonte' progressivement comme une bulle.",
-      "Principe : On ins\xC3\xA8re chaque \xC3\xA9l\xC3\xA9ment \xC3\xA0 sa "
-      "place "
-      "dans la partie tri\xC3\xA9\x65, comme on range des cartes \xC3\xA0 "
-      "jouer.",
-      "Principe : Am\xC3\xA9lioration du tri par insertion utilisant un "
-      "ecart qui diminue, permettant des d\xC3\xA9placements rapides.",
-      "Principe : Utilise un pivot pour diviser le tableau en deux parties "
-      "(plus petits / plus grands) et r\xC3\xA9"
-      "curse."};
-
-  GtkWidget *lbl_title = gtk_label_new(NULL);
-  char title_markup[256];
-  snprintf(
-      title_markup, 256,
-      "<span size='xx-large' weight='heavy' foreground='#D600B2'>%s</span>",
-      algo_names[algo_idx]);
-  gtk_label_set_markup(GTK_LABEL(lbl_title), title_markup);
-  gtk_box_pack_start(GTK_BOX(left_vbox), lbl_title, FALSE, FALSE, 0);
+  p->lbl_title = gtk_label_new(NULL);
+  gtk_box_pack_start(GTK_BOX(left_vbox), p->lbl_title, FALSE, FALSE, 0);
 
-  GtkWidget *lbl_princ = gtk_label_new(algo_desc[algo_idx]);
-  gtk_label_set_line_wrap(GTK_LABEL(lbl_princ), TRUE);
-  gtk_label_set_max_width_chars(GTK_LABEL(lbl_princ), 50);
-  gtk_box_pack_start(GTK_BOX(left_vbox), lbl_princ, FALSE, FALSE, 0);
+  p->lbl_princ = gtk_label_new(NULL);
+  gtk_label_set_line_wrap(GTK_LABEL(p->lbl_princ), TRUE);
+  gtk_label_set_max_width_chars(GTK_LABEL(p->lbl_princ), 50);
+  gtk_box_pack_start(GTK_BOX(left_vbox), p->lbl_princ, FALSE, FALSE, 0);
 
   // Visual Canvas
   app->anim_canvas = gtk_drawing_area_new();
@@ -4498,6 +9949,53 @@ static void open_animation_window(AppData *app) {
                    app);
   gtk_box_pack_start(GTK_BOX(left_vbox), app->anim_canvas, TRUE, TRUE, 10);
 
+  // Playback: transport buttons, then the scrub bar
+  GtkWidget *hbox_play = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0);
+  gtk_style_context_add_class(gtk_widget_get_style_context(hbox_play),
+                              "linked");
+  gtk_widget_set_halign(hbox_play, GTK_ALIGN_CENTER);
+  gtk_box_pack_start(GTK_BOX(left_vbox), hbox_play, FALSE, FALSE, 0);
+  add_trace_button(hbox_play, "D\xC3\xA9" "but", G_CALLBACK(on_trace_first),
+                   p);
+  add_trace_button(hbox_play, "\xE2\x97\x80 Pas",
+                   G_CALLBACK(on_trace_step_back), p);
+  add_trace_button(hbox_play, "\xE2\x97\x80\xE2\x97\x80 Arri\xC3\xA8re",
+                   G_CALLBACK(on_trace_rewind), p);
+  p->btn_play =
+      add_trace_button(hbox_play, "Lecture", G_CALLBACK(on_trace_play), p);
+  add_trace_button(hbox_play, "Pas \xE2\x96\xB6", G_CALLBACK(on_trace_step),
+                   p);
+  add_trace_button(hbox_play, "Fin", G_CALLBACK(on_trace_last), p);
+
+  GtkWidget *hbox_scrub = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
+  gtk_box_pack_start(GTK_BOX(left_vbox), hbox_scrub, FALSE, FALSE, 0);
+  p->scrub = gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, 0, 1, 1);
+  gtk_scale_set_draw_value(GTK_SCALE(p->scrub), FALSE);
+  g_signal_connect(p->scrub, "value-changed", G_CALLBACK(on_trace_scrub), p);
+  gtk_box_pack_start(GTK_BOX(hbox_scrub), p->scrub, TRUE, TRUE, 0);
+  p->lbl_pos = gtk_label_new(NULL);
+  gtk_box_pack_start(GTK_BOX(hbox_scrub), p->lbl_pos, FALSE, FALSE, 0);
+
+  GtkWidget *hbox_opts = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
+  gtk_box_pack_start(GTK_BOX(left_vbox), hbox_opts, FALSE, FALSE, 0);
+  gtk_box_pack_start(GTK_BOX(hbox_opts), gtk_label_new("Vitesse :"), FALSE,
+                     FALSE, 0);
+  GtkWidget *speed_scale =
+      gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, 0, 100, 1);
+  gtk_scale_set_draw_value(GTK_SCALE(speed_scale), FALSE);
+  gtk_range_set_value(GTK_RANGE(speed_scale),
+                      CLAMP(25.0 * log10(p->rate), 0, 100));
+  gtk_widget_set_size_request(speed_scale, 200, -1);
+  g_signal_connect(speed_scale, "value-changed", G_CALLBACK(on_trace_speed),
+                   p);
+  gtk_box_pack_start(GTK_BOX(hbox_opts), speed_scale, FALSE, FALSE, 0);
+  GtkWidget *btn_load = gtk_button_new_with_label("Charger");
+  g_signal_connect(btn_load, "clicked", G_CALLBACK(on_trace_load), p);
+  gtk_box_pack_end(GTK_BOX(hbox_opts), btn_load, FALSE, FALSE, 0);
+  GtkWidget *btn_save = gtk_button_new_with_label("Enregistrer");
+  g_signal_connect(btn_save, "clicked", G_CALLBACK(on_trace_save), p);
+  gtk_box_pack_end(GTK_BOX(hbox_opts), btn_save, FALSE, FALSE, 0);
+
   // --- Right Side: Pseudo-code ---
   GtkWidget *right_vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 10);
   gtk_widget_set_size_request(right_vbox, 400, -1);
@@ -4526,35 +10024,23 @@ static void open_animation_window(AppData *app) {
                              PANGO_WEIGHT_BOLD, NULL);
   gtk_container_add(GTK_CONTAINER(scrolled), app->pseudo_view);
 
-  // --- Start Demo Logic ---
-  if (app->demo_array)
-    free_array(app->demo_array);
-
-  // Increase to 12 elements for better visualization
-  int n_demo = 12;
-  app->demo_array = create_array(DATA_INT, n_demo);
-  int demo_init[] = {15, 3, 11, 7, 19, 2, 14, 8, 1, 12, 6, 17};
-  for (int i = 0; i < n_demo; i++)
-    ((int *)app->demo_array->data)[i] = demo_init[i];
-
-  app->animation_speed = 0.8;
-  app->is_benchmarking = FALSE;
-
   gtk_widget_show_all(app->anim_win);
   g_signal_connect(app->anim_win, "destroy", G_CALLBACK(on_anim_window_destroy),
                    app);
 
-  while (gtk_events_pending())
-    gtk_main_iteration();
-
-  sort_array_wrapper(app, app->demo_array, algo_idx);
+  trace_player_set_trace(p, trace);
+  trace_player_play(p, 1);
 }
 
 static void on_anim_window_destroy(GtkWidget *widget, gpointer user_data) {
   AppData *app = (AppData *)user_data;
-  if (app->demo_array) {
-    free_array(app->demo_array);
-    app->demo_array = NULL;
+  TracePlayer *p = app->player;
+  if (p) {
+    if (p->timer)
+      g_source_remove(p->timer);
+    trace_player_clear(p);
+    g_free(p);
+    app->player = NULL;
   }
   app->pseudo_buffer = NULL;
   app->anim_canvas = NULL;
@@ -4563,7 +10049,30 @@ static void on_anim_window_destroy(GtkWidget *widget, gpointer user_data) {
 
 void on_animate_launch(GtkWidget *widget, gpointer user_data) {
   AppData *app = (AppData *)user_data;
-  open_animation_window(app);
+  open_animation_window(app, NULL);
+}
+
+// Closing the window stops the benchmark; its points land in the data only
+static void on_compare_window_destroy(GtkWidget *widget, gpointer user_data) {
+  AppData *app = (AppData *)user_data;
+  cancel_comparison_benchmark(app);
+  app->compare_window = NULL;
+  app->comparison_canvas = NULL;
+  app->comparison_progress = NULL;
+  app->comparison_cancel = NULL;
+  app->comparison_suite_combo = NULL;
+  app->comparison_restart = FALSE;
+}
+
+// A running benchmark is cancelled first; bench_finished() starts the new one
+static void on_compare_suite_changed(GtkComboBox *combo, gpointer user_data) {
+  AppData *app = (AppData *)user_data;
+  if (app->bench_job) {
+    app->comparison_restart = TRUE;
+    cancel_comparison_benchmark(app);
+    return;
+  }
+  run_comparison_benchmark(app);
 }
 
 void on_compare_launch(GtkWidget *widget, gpointer user_data) {
@@ -4575,7 +10084,7 @@ void on_compare_launch(GtkWidget *widget, gpointer user_data) {
                          "ANALYSE DES PERFORMANCES");
     gtk_window_set_default_size(GTK_WINDOW(app->compare_window), 800, 600);
     g_signal_connect(app->compare_window, "destroy",
-                     G_CALLBACK(gtk_widget_destroyed), &app->compare_window);
+                     G_CALLBACK(on_compare_window_destroy), app);
 
     GtkWidget *vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 10);
     gtk_container_add(GTK_CONTAINER(app->compare_window), vbox);
@@ -4592,6 +10101,64 @@ void on_compare_launch(GtkWidget *widget, gpointer user_data) {
                      app);
     gtk_box_pack_start(GTK_BOX(hbox_tools), btn_export, FALSE, FALSE, 0);
 
+    app->comparison_cancel = gtk_button_new_with_label("ANNULER");
+    gtk_style_context_add_class(
+        gtk_widget_get_style_context(app->comparison_cancel),
+        "destructive-action");
+    gtk_widget_set_sensitive(app->comparison_cancel, FALSE);
+    g_signal_connect(app->comparison_cancel, "clicked",
+                     G_CALLBACK(on_compare_cancel), app);
+    gtk_box_pack_start(GTK_BOX(hbox_tools), app->comparison_cancel, FALSE,
+                       FALSE, 0);
+
+    // Regression gate: store the fitted constants, check a later run
+    GtkWidget *btn_save_base =
+        gtk_button_new_with_label("ENREGISTRER R\xC3\x89\x46\xC3\x89RENCE");
+    g_signal_connect(btn_save_base, "clicked",
+                     G_CALLBACK(save_comparison_baseline), app);
+    gtk_box_pack_start(GTK_BOX(hbox_tools), btn_save_base, FALSE, FALSE, 0);
+    GtkWidget *btn_load_base = gtk_button_new_with_label("COMPARER");
+    g_signal_connect(btn_load_base, "clicked",
+                     G_CALLBACK(load_comparison_baseline), app);
+    gtk_box_pack_start(GTK_BOX(hbox_tools), btn_load_base, FALSE, FALSE, 0);
+
+    app->comparison_suite_combo = gtk_combo_box_text_new();
+    for (int s = 0; s < NUM_BENCH_SUITES; s++)
+      gtk_combo_box_text_append_text(
+          GTK_COMBO_BOX_TEXT(app->comparison_suite_combo),
+          bench_suites[s].title);
+    g_signal_connect(app->comparison_suite_combo, "changed",
+                     G_CALLBACK(on_compare_suite_changed), app);
+    gtk_box_pack_start(GTK_BOX(hbox_tools), app->comparison_suite_combo,
+                       FALSE, FALSE, 0);
+
+    // Every point carries its counters; pick what to plot. Operation
+    // counts need SORT_STATS, CPU counters need Linux.
+    GtkWidget *metric_combo = gtk_combo_box_text_new();
+    for (int m = 0; m < NUM_METRICS; m++) {
+#ifndef SORT_STATS
+      if (m >= METRIC_COMPARISONS && m <= METRIC_BYTES)
+        continue;
+#endif
+#ifndef HAVE_PERF_EVENTS
+      if (m >= METRIC_IPC && m <= METRIC_LLC_MISSES)
+        continue;
+#endif
+      char id[8];
+      snprintf(id, sizeof(id), "%d", m);
+      gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(metric_combo), id,
+                                compare_metric_titles[m]);
+    }
+    char active[8];
+    snprintf(active, sizeof(active), "%d", app->compare_metric);
+    if (!gtk_combo_box_set_active_id(GTK_COMBO_BOX(metric_combo), active))
+      gtk_combo_box_set_active(GTK_COMBO_BOX(metric_combo), 0);
+    g_signal_connect(metric_combo, "changed",
+                     G_CALLBACK(on_compare_metric_changed), app);
+    gtk_box_pack_end(GTK_BOX(hbox_tools), metric_combo, FALSE, FALSE, 0);
+    gtk_box_pack_end(GTK_BOX(hbox_tools), gtk_label_new("Axe Y :"), FALSE,
+                     FALSE, 0);
+
     app->comparison_canvas = gtk_drawing_area_new();
     gtk_box_pack_start(GTK_BOX(vbox), app->comparison_canvas, TRUE, TRUE, 0);
     g_signal_connect(app->comparison_canvas, "draw",
@@ -4606,6 +10173,22 @@ void on_compare_launch(GtkWidget *widget, gpointer user_data) {
   }
 
   gtk_widget_show_all(app->compare_window);
+  if (app->bench_job) // Still running: the window follows it
+    return;
+
+  // Measure what the current view shows
+  const char *vis_child =
+      gtk_stack_get_visible_child_name(GTK_STACK(app->view_stack));
+  BenchSuite suite = SUITE_SORT;
+  if (g_strcmp0(vis_child, "view_tree") == 0)
+    suite = SUITE_TREE;
+  else if (g_strcmp0(vis_child, "view_graph") == 0)
+    suite = SUITE_GRAPH;
+  g_signal_handlers_block_by_func(app->comparison_suite_combo,
+                                  on_compare_suite_changed, app);
+  gtk_combo_box_set_active(GTK_COMBO_BOX(app->comparison_suite_combo), suite);
+  g_signal_handlers_unblock_by_func(app->comparison_suite_combo,
+                                    on_compare_suite_changed, app);
   run_comparison_benchmark(app);
 }
 
@@ -4797,6 +10380,11 @@ void on_speed_changed(GtkRange *range, gpointer user_data) {
   app->animation_speed = val / 100.0;
 }
 
+void on_threads_changed(GtkSpinButton *spin, gpointer user_data) {
+  AppData *app = (AppData *)user_data;
+  app->sort_threads = gtk_spin_button_get_value_as_int(spin);
+}
+
 void on_reset_session(GtkWidget *widget, gpointer user_data) {
   AppData *app = (AppData *)user_data;
   app->total_ops = 0;
@@ -5014,6 +10602,27 @@ void show_history_popup(GtkWidget *widget, gpointer user_data) {
   gtk_widget_show_all(dialog);
 }
 
+// Typed "timeline": saves the profiling spans recorded so far.
+static void export_timeline(AppData *app) {
+  char *filename = run_file_dialog(
+      app, app->window, GTK_FILE_CHOOSER_ACTION_SAVE,
+      "EXPORTER LA CHRONOLOGIE", "Exporter", "*.json",
+      "Chrome trace / Perfetto (*.json)", "chronologie.json");
+  if (!filename)
+    return;
+  FILE *f = fopen(filename, "w");
+  g_free(filename);
+  if (!f) {
+    set_status(app, "Erreur d'export de la chronologie");
+    return;
+  }
+  size_t written = prof_write_chrome_trace(f);
+  fclose(f);
+  set_status(app,
+             "Chronologie export\xC3\xA9\x65 (%zu \xC3\xA9v\xC3\xA9nements)",
+             written);
+}
+
 gboolean on_window_key_press(GtkWidget *widget, GdkEventKey *event,
                              gpointer user_data) {
   AppData *app = (AppData *)user_data;
@@ -5035,6 +10644,9 @@ gboolean on_window_key_press(GtkWidget *widget, GdkEventKey *event,
     } else if (strstr(app->cmd_buffer, "mode")) {
       show_mode_popup(NULL, app);
       app->cmd_buffer[0] = '\0';
+    } else if (strstr(app->cmd_buffer, "timeline")) {
+      app->cmd_buffer[0] = '\0';
+      export_timeline(app);
     }
   } else if (event->keyval == GDK_KEY_Escape ||
              event->keyval == GDK_KEY_BackSpace) {
@@ -5149,10 +10761,496 @@ GtkWidget *create_stat_card(const char *title, GtkWidget **val_label_ptr) {
   return frame;
 }
 
+// =============================================================================
+//                             BENCHMARK EN LIGNE DE COMMANDE
+// =============================================================================
+// DataStructureProject --bench [--algos=quick,tim] [--types=int,string]
+//     [--sizes=1000,100000] [--dists=random] [--threads=1,4] [--reps=N]
+//     [--warmup=N] [--seed=N] [--list] [--format=csv|json] [--output=FICHIER]
+//     [--save-baseline=FICHIER] [--baseline=FICHIER] [--tolerance=PCT]
+//     [--timeline=FICHIER]
+// Runs the comparison protocol without a display and writes one record per
+// point, so runs on different commits can be diffed. With --baseline it is a
+// regression gate: the exit status is 3 when a fitted constant grew by more
+// than the tolerance. --timeline dumps the profiling spans of the run.
+
+// Comma list of keys, or "all"; returns how many indices were stored in out
+// (at most num_keys), -1 on an unknown key.
+static int bench_parse_keys(const char *arg, const char *const *keys,
+                            int num_keys, int *out) {
+  if (g_strcmp0(arg, "all") == 0) {
+    for (int i = 0; i < num_keys; i++)
+      out[i] = i;
+    return num_keys;
+  }
+  gchar **parts = g_strsplit(arg, ",", -1);
+  int n = 0;
+  for (int i = 0; parts[i] && n >= 0; i++) {
+    const char *part = g_strstrip(parts[i]);
+    int k = -1;
+    for (int j = 0; j < num_keys && k < 0; j++)
+      if (g_ascii_strcasecmp(part, keys[j]) == 0)
+        k = j;
+    if (k < 0) {
+      g_printerr("Valeur inconnue : %s\n", part);
+      n = -1;
+    } else if (n < num_keys) {
+      out[n++] = k;
+    }
+  }
+  g_strfreev(parts);
+  return n;
+}
+
+// Comma list of positive integers; returns the count, -1 on a bad entry
+static int bench_parse_numbers(const char *arg, size_t **out) {
+  gchar **parts = g_strsplit(arg, ",", -1);
+  int n = 0, cap = g_strv_length(parts);
+  *out = g_new(size_t, MAX(cap, 1));
+  for (int i = 0; parts[i] && n >= 0; i++) {
+    char *end = NULL;
+    guint64 v = g_ascii_strtoull(g_strstrip(parts[i]), &end, 10);
+    if (!end || *end != '\0' || v == 0) {
+      g_printerr("Nombre invalide : %s\n", parts[i]);
+      n = -1;
+    } else {
+      (*out)[n++] = (size_t)v;
+    }
+  }
+  g_strfreev(parts);
+  return n;
+}
+
+typedef struct {
+  FILE *out;
+  gboolean json;
+  uint64_t seed;
+  int rows;
+} BenchWriter;
+
+static void bench_write_begin(BenchWriter *w) {
+  if (w->json)
+    fprintf(w->out, "{\"results\": [\n");
+  else
+    fprintf(w->out,
+            "structure,algo,type,dist,seed,threads,n,runs,median_ns,min_ns,"
+            "p95_ns,stddev_ns,ci_lo_ns,ci_hi_ns,comparisons,swaps,moves,"
+            "bytes_moved,allocations,cycles,instructions,cache_misses,"
+            "branch_misses,llc_misses,mem_bytes,mem_blocks,"
+            "bytes_per_element\n");
+}
+
+static void bench_write_row(BenchWriter *w, BenchSuite suite,
+                            StructureType kind, int algo, int type, int dist,
+                            int threads, const PerformancePoint *p) {
+  const char *structure = bench_structure_key(suite, kind);
+  const char *algo_key = bench_suites[suite].keys[algo];
+  if (w->json) {
+    fprintf(w->out,
+            "%s  {\"structure\": \"%s\", \"algo\": \"%s\", \"type\": \"%s\", "
+            "\"dist\": \"%s\", \"seed\": %" G_GUINT64_FORMAT
+            ", \"threads\": %d, \"n\": %zu, \"runs\": %d, "
+            "\"median_ns\": %.0f, \"min_ns\": %.0f, \"p95_ns\": %.0f, "
+            "\"stddev_ns\": %.1f, \"ci_lo_ns\": %.0f, \"ci_hi_ns\": %.0f, "
+            "\"comparisons\": %" G_GUINT64_FORMAT
+            ", \"swaps\": %" G_GUINT64_FORMAT ", \"moves\": %" G_GUINT64_FORMAT
+            ", \"bytes_moved\": %" G_GUINT64_FORMAT
+            ", \"allocations\": %" G_GUINT64_FORMAT,
+            w->rows ? ",\n" : "", structure, algo_key,
+            bench_type_keys[type], dist_keys[dist], w->seed, threads,
+            p->size, p->runs, p->time_ns, p->time_min, p->time_p95, p->time_stddev,
+            p->time_ci_lo, p->time_ci_hi, p->ops.comparisons, p->ops.swaps,
+            p->ops.moves, p->ops.bytes_moved, p->ops.allocations);
+  } else {
+    fprintf(w->out,
+            "%s,%s,%s,%s,%" G_GUINT64_FORMAT
+            ",%d,%zu,%d,%.0f,%.0f,%.0f,%.1f,%.0f,%.0f,"
+            "%" G_GUINT64_FORMAT ",%" G_GUINT64_FORMAT ",%" G_GUINT64_FORMAT
+            ",%" G_GUINT64_FORMAT ",%" G_GUINT64_FORMAT,
+            structure, algo_key, bench_type_keys[type],
+            dist_keys[dist], w->seed, threads, p->size, p->runs, p->time_ns,
+            p->time_min, p->time_p95, p->time_stddev, p->time_ci_lo,
+            p->time_ci_hi, p->ops.comparisons, p->ops.swaps, p->ops.moves,
+            p->ops.bytes_moved, p->ops.allocations);
+  }
+  // Counters the kernel did not provide are null / empty
+  for (int c = 0; c < NUM_HW_COUNTERS; c++) {
+    gboolean valid = (p->hw_valid & (1u << c)) != 0;
+    if (w->json && valid)
+      fprintf(w->out, ", \"%s\": %" G_GUINT64_FORMAT, hw_counter_keys[c],
+              p->hw[c]);
+    else if (w->json)
+      fprintf(w->out, ", \"%s\": null", hw_counter_keys[c]);
+    else if (valid)
+      fprintf(w->out, ",%" G_GUINT64_FORMAT, p->hw[c]);
+    else
+      fputc(',', w->out);
+  }
+  double per_elem = p->size ? (double)p->mem_bytes / p->size : 0;
+  if (w->json)
+    fprintf(w->out,
+            ", \"mem_bytes\": %" G_GINT64_FORMAT
+            ", \"mem_blocks\": %" G_GINT64_FORMAT
+            ", \"bytes_per_element\": %.2f}",
+            p->mem_bytes, p->mem_blocks, per_elem);
+  else
+    fprintf(w->out, ",%" G_GINT64_FORMAT ",%" G_GINT64_FORMAT ",%.2f\n",
+            p->mem_bytes, p->mem_blocks, per_elem);
+  w->rows++;
+  fflush(w->out);
+}
+
+static void bench_write_end(BenchWriter *w) {
+  if (w->json)
+    fprintf(w->out, "\n]}\n");
+}
+
+// Entry point of --bench; returns the process exit status
+static int run_bench_cli(int argc, char *argv[]) {
+  gboolean bench = FALSE, list_mode = FALSE;
+  gchar *algos_arg = NULL, *types_arg = NULL, *sizes_arg = NULL;
+  gchar *dists_arg = NULL, *threads_arg = NULL, *format_arg = NULL;
+  gchar *output_arg = NULL, *seed_arg = NULL;
+  gchar *baseline_arg = NULL, *save_baseline_arg = NULL;
+  gchar *timeline_arg = NULL, *suite_arg = NULL, *structures_arg = NULL;
+  int reps = 0, warmup = bench_default_protocol.warmup;
+  double tolerance = BASELINE_TOLERANCE * 100;
+
+  GOptionEntry entries[] = {
+      {"bench", 0, 0, G_OPTION_ARG_NONE, &bench,
+       "Benchmark sans interface graphique", NULL},
+      {"suite", 0, 0, G_OPTION_ARG_STRING, &suite_arg,
+       "sort, list, tree ou graph (d\xC3\xA9"
+       "faut : sort)",
+       "SUITE"},
+      {"algos", 0, 0, G_OPTION_ARG_STRING, &algos_arg,
+       "Op\xC3\xA9rations de la suite ou all (d\xC3\xA9"
+       "faut : all) ; sort : "
+       "bubble,insertion,shell,quick,intro,radix,parallel,tim",
+       "LISTE"},
+      {"types", 0, 0, G_OPTION_ARG_STRING, &types_arg,
+       "int,float,char,string ou all (d\xC3\xA9"
+       "faut : int)",
+       "LISTE"},
+      {"sizes", 0, 0, G_OPTION_ARG_STRING, &sizes_arg,
+       "Tailles (d\xC3\xA9"
+       "faut selon la suite, sort : 1000,10000,100000)",
+       "LISTE"},
+      {"dists", 0, 0, G_OPTION_ARG_STRING, &dists_arg,
+       "random,sorted,reversed,sawtooth,organpipe,ksorted,fewunique,zipf,"
+       "equal ou all (d\xC3\xA9"
+       "faut : random)",
+       "LISTE"},
+      {"threads", 0, 0, G_OPTION_ARG_STRING, &threads_arg,
+       "Threads du tri parall\xC3\xA8le (d\xC3\xA9"
+       "faut : un par c\xC5\x93ur)",
+       "LISTE"},
+      {"reps", 0, 0, G_OPTION_ARG_INT, &reps,
+       "Mesures par point (d\xC3\xA9"
+       "faut : 3 \xC3\xA0 15 dans 1 s)",
+       "N"},
+      {"seed", 0, 0, G_OPTION_ARG_STRING, &seed_arg,
+       "Graine des donn\xC3\xA9"
+       "es : m\xC3\xAA"
+       "mes entr\xC3\xA9"
+       "es \xC3\xA0 chaque ex\xC3\xA9"
+       "cution (d\xC3\xA9"
+       "faut : al\xC3\xA9"
+       "atoire)",
+       "N"},
+      {"warmup", 0, 0, G_OPTION_ARG_INT, &warmup,
+       "Tours de chauffe non mesur\xC3\xA9s", "N"},
+      {"list", 0, 0, G_OPTION_ARG_NONE, &list_mode,
+       "Trier des listes cha\xC3\xAEn\xC3\xA9"
+       "es au lieu de tableaux (comme --structures=list)",
+       NULL},
+      {"structures", 0, 0, G_OPTION_ARG_STRING, &structures_arg,
+       "Suites sort et list : array,list,dlist,unrolled,skip ou all "
+       "(d\xC3\xA9"
+       "faut : array, list pour la suite list)",
+       "LISTE"},
+      {"format", 0, 0, G_OPTION_ARG_STRING, &format_arg,
+       "csv ou json (d\xC3\xA9"
+       "faut : csv)",
+       "FORMAT"},
+      {"output", 'o', 0, G_OPTION_ARG_FILENAME, &output_arg,
+       "Fichier de sortie (d\xC3\xA9"
+       "faut : sortie standard)",
+       "FICHIER"},
+      {"save-baseline", 0, 0, G_OPTION_ARG_FILENAME, &save_baseline_arg,
+       "Enregistrer le mod\xC3\xA8le ajust\xC3\xA9 de chaque courbe",
+       "FICHIER"},
+      {"baseline", 0, 0, G_OPTION_ARG_FILENAME, &baseline_arg,
+       "Comparer les constantes ajust\xC3\xA9\x65s \xC3\xA0 une "
+       "r\xC3\xA9\x66\xC3\xA9rence (code 3 si r\xC3\xA9gression)",
+       "FICHIER"},
+      {"tolerance", 0, 0, G_OPTION_ARG_DOUBLE, &tolerance,
+       "Hausse tol\xC3\xA9r\xC3\xA9\x65 de la constante, en % "
+       "(d\xC3\xA9"
+       "faut : 10)",
+       "PCT"},
+      {"timeline", 0, 0, G_OPTION_ARG_FILENAME, &timeline_arg,
+       "Chronologie des phases au format Chrome trace (Perfetto)",
+       "FICHIER"},
+      {NULL}};
+
+  GOptionContext *opt = g_option_context_new("- benchmark des tris");
+  g_option_context_add_main_entries(opt, entries, NULL);
+  GError *error = NULL;
+  gboolean parsed = g_option_context_parse(opt, &argc, &argv, &error);
+  g_option_context_free(opt);
+
+  int algos[BENCH_MAX_OPS], types[G_N_ELEMENTS(bench_type_keys)];
+  int dists[NUM_DISTS], structures[NUM_STRUCTURES];
+  int num_algos = -1, num_types = -1, num_dists = -1, num_structures = -1;
+  int num_sizes = -1, num_threads = -1;
+  size_t *sizes = NULL, *threads = NULL;
+  BenchSuite suite = SUITE_SORT;
+  if (parsed && suite_arg) {
+    int s = 0;
+    while (s < NUM_BENCH_SUITES && g_strcmp0(suite_arg, bench_suites[s].key))
+      s++;
+    if (s == NUM_BENCH_SUITES) {
+      g_printerr("Suite inconnue : %s\n", suite_arg);
+      parsed = FALSE;
+    }
+    suite = (BenchSuite)MIN(s, NUM_BENCH_SUITES - 1);
+  }
+  const BenchSuiteInfo *info = &bench_suites[suite];
+  if (!parsed) {
+    if (error) {
+      g_printerr("%s\n", error->message);
+      g_error_free(error);
+    }
+  } else {
+    num_algos = bench_parse_keys(algos_arg ? algos_arg : "all", info->keys,
+                                 info->num_ops, algos);
+    num_types = bench_parse_keys(types_arg ? types_arg : "int",
+                                 bench_type_keys,
+                                 G_N_ELEMENTS(bench_type_keys), types);
+    num_dists = bench_parse_keys(dists_arg ? dists_arg : "random", dist_keys,
+                                 NUM_DISTS, dists);
+    // Trees and graphs have a single structure; the list suite has no array
+    const char *default_structure =
+        list_mode || suite == SUITE_LIST ? "list" : "array";
+    if (suite == SUITE_TREE || suite == SUITE_GRAPH) {
+      num_structures = 1;
+      structures[0] = STRUCTURE_ARRAY;
+    } else if (suite == SUITE_LIST && g_strcmp0(structures_arg, "all") == 0) {
+      num_structures = bench_parse_keys("list,dlist,unrolled,skip",
+                                        structure_keys,
+                                        NUM_STRUCTURES, structures);
+    } else {
+      num_structures = bench_parse_keys(
+          structures_arg ? structures_arg : default_structure, structure_keys,
+          NUM_STRUCTURES, structures);
+    }
+    for (int i = 0; i < num_structures; i++) {
+      if (suite == SUITE_LIST && structures[i] == STRUCTURE_ARRAY) {
+        g_printerr("Structure inutilisable avec la suite list : array\n");
+        num_structures = -1;
+      }
+    }
+    num_sizes = bench_parse_numbers(sizes_arg ? sizes_arg : info->default_sizes,
+                                    &sizes);
+    if (threads_arg) {
+      num_threads = bench_parse_numbers(threads_arg, &threads);
+    } else {
+      num_threads = 1;
+      threads = g_new(size_t, 1);
+      threads[0] = (size_t)resolve_sort_threads(0);
+    }
+  }
+
+  gboolean json = g_strcmp0(format_arg, "json") == 0;
+  FILE *out = stdout;
+  int status = 0;
+  uint64_t seed = (uint64_t)g_get_real_time();
+  if (seed_arg) {
+    char *end = NULL;
+    seed = g_ascii_strtoull(seed_arg, &end, 0);
+    if (!end || *end != '\0' || end == seed_arg) {
+      g_printerr("Graine invalide : %s\n", seed_arg);
+      status = 2;
+    }
+  }
+  Baseline *baseline = NULL;
+  FILE *save_baseline = NULL, *timeline = NULL;
+  if (status != 0 || num_algos <= 0 || num_types <= 0 || num_dists <= 0 ||
+      num_structures <= 0 || num_sizes <= 0 || num_threads <= 0 || reps < 0 ||
+      warmup < 0 || tolerance < 0) {
+    status = 2;
+  } else if (baseline_arg && !(baseline = baseline_load(baseline_arg))) {
+    g_printerr("R\xC3\xA9\x66\xC3\xA9rence illisible : %s\n", baseline_arg);
+    status = 2;
+  } else if (format_arg && !json && g_strcmp0(format_arg, "csv") != 0) {
+    g_printerr("Format inconnu : %s\n", format_arg);
+    status = 2;
+  } else if (output_arg && !(out = fopen(output_arg, "w"))) {
+    g_printerr("Impossible d'\xC3\xA9"
+               "crire %s\n",
+               output_arg);
+    out = stdout;
+    status = 1;
+  } else if (save_baseline_arg &&
+             !(save_baseline = fopen(save_baseline_arg, "w"))) {
+    g_printerr("Impossible d'\xC3\xA9"
+               "crire %s\n",
+               save_baseline_arg);
+    status = 1;
+  } else if (timeline_arg && !(timeline = fopen(timeline_arg, "w"))) {
+    g_printerr("Impossible d'\xC3\xA9"
+               "crire %s\n",
+               timeline_arg);
+    status = 1;
+  }
+
+  if (status == 0) {
+    BenchProtocol proto = bench_default_protocol;
+    proto.warmup = warmup;
+    if (reps > 0) // Fixed count: comparable across machines and commits
+      proto.min_runs = proto.max_runs = reps;
+    AppData *ctx = g_new0(AppData, 1);
+    ctx->is_benchmarking = TRUE;
+    BenchWriter w = {out, json, seed, 0};
+    PerfCounters *perf = perf_counters_open();
+    task_pools_begin_private();
+    g_printerr("Graine : %" G_GUINT64_FORMAT "\n", seed);
+    if (!perf)
+      g_printerr("Compteurs mat\xC3\xA9riels indisponibles "
+                 "(perf_event_open)\n");
+    if (save_baseline)
+      baseline_write_header(save_baseline);
+    if ((save_baseline || baseline) && num_sizes < FIT_MIN_POINTS)
+      g_printerr("Au moins %d tailles sont n\xC3\xA9"
+                 "cessaires pour "
+                 "ajuster les courbes\n",
+                 FIT_MIN_POINTS);
+    PerformancePoint *pts = g_new(PerformancePoint, num_sizes);
+    int regressions = 0;
+    bench_write_begin(&w);
+
+    for (int t = 0; t < num_types; t++) {
+      for (int d = 0; d < num_dists; d++) {
+        for (int st = 0; st < num_structures; st++) {
+          StructureType structure = (StructureType)structures[st];
+          for (int a = 0; a < num_algos; a++) {
+            int algo = algos[a];
+            if (bench_op_max_size(suite, structure, algo) == 0) {
+              g_printerr("%s %s ignor\xC3\xA9 (sans objet pour cette "
+                         "structure)\n",
+                         bench_structure_key(suite, structure),
+                         info->keys[algo]);
+              continue;
+            }
+            // Thread counts only change Parallel Sort
+            gboolean threaded = bench_op_threaded(suite, algo);
+            int thread_runs = threaded ? num_threads : 1;
+            for (int k = 0; k < thread_runs; k++) {
+              ctx->sort_threads = threaded ? (int)threads[k] : 1;
+              int used = threaded ? resolve_sort_threads(ctx->sort_threads) : 1;
+              memset(pts, 0, num_sizes * sizeof(PerformancePoint));
+              for (int s = 0; s < num_sizes; s++) {
+                size_t limit = bench_op_max_size(suite, structure, algo);
+                if (sizes[s] > limit) {
+                  g_printerr("%s %s n=%zu ignor\xC3\xA9 (trop lent "
+                             "au-del\xC3\xA0 de %zu)\n",
+                             bench_structure_key(suite, structure),
+                             info->keys[algo], sizes[s], limit);
+                  continue;
+                }
+                PerformancePoint *p = &pts[s];
+                p->size = sizes[s];
+                bench_measure_point(ctx, &proto, perf, seed, suite,
+                                    (DataType)types[t], (Distribution)dists[d],
+                                    structure, algo, sizes[s], NULL, p);
+                bench_write_row(&w, suite, structure, algo, types[t], dists[d],
+                                used, p);
+                g_printerr("%s %s %s %s t=%d n=%zu : %.3f ms (%d mesures)\n",
+                           bench_structure_key(suite, structure),
+                           info->keys[algo], bench_type_keys[types[t]],
+                           dist_keys[dists[d]], used, sizes[s],
+                           p->time_ns / 1e6, p->runs);
+              }
+
+              // Fit the whole curve, then store it or check it
+              char key[BASELINE_KEY_LEN];
+              baseline_key(key, suite, structure, algo, types[t], dists[d],
+                           used);
+              ComplexityFit fit;
+              if (fit_complexity(pts, num_sizes, METRIC_TIME, &fit)) {
+                g_printerr("%s : %.3g ns \xC2\xB7 %s (R\xC2\xB2 %.3f)\n", key,
+                           fit.constant, model_labels[fit.model], fit.r2);
+                if (save_baseline)
+                  baseline_write(save_baseline, key, &fit);
+              }
+              const BaselineEntry *base = baseline_find(baseline, key);
+              double ratio;
+              if (baseline && !base) {
+                g_printerr("%s : absent de la r\xC3\xA9\x66\xC3\xA9rence\n",
+                           key);
+              } else if (base && baseline_ratio(base, pts, num_sizes, &ratio)) {
+                gboolean regressed = ratio > 1 + tolerance / 100;
+                g_printerr("%s%s : constante \xC3\x97%.3f de la "
+                           "r\xC3\xA9\x66\xC3\xA9rence (%s)\n",
+                           regressed ? "R\xC3\x89GRESSION " : "", key, ratio,
+                           model_labels[base->fit.model]);
+                regressions += regressed;
+              }
+            }
+          }
+        }
+      }
+    }
+    bench_write_end(&w);
+    task_pools_end_private();
+    perf_counters_close(perf);
+    g_free(pts);
+    g_free(ctx);
+    if (regressions > 0) {
+      g_printerr("%d r\xC3\xA9gression(s) au-del\xC3\xA0 de +%.0f %%\n",
+                 regressions, tolerance);
+      status = 3;
+    }
+  }
+
+  if (out != stdout)
+    fclose(out);
+  if (save_baseline)
+    fclose(save_baseline);
+  if (timeline) {
+    g_printerr("Chronologie : %zu \xC3\xA9v\xC3\xA9nements\n",
+               prof_write_chrome_trace(timeline));
+    fclose(timeline);
+  }
+  baseline_free(baseline);
+  g_free(sizes);
+  g_free(threads);
+  g_free(algos_arg);
+  g_free(types_arg);
+  g_free(sizes_arg);
+  g_free(dists_arg);
+  g_free(threads_arg);
+  g_free(format_arg);
+  g_free(output_arg);
+  g_free(seed_arg);
+  g_free(baseline_arg);
+  g_free(save_baseline_arg);
+  g_free(timeline_arg);
+  g_free(suite_arg);
+  return status;
+}
+
 int main(int argc, char *argv[]) {
   setlocale(LC_NUMERIC, "C");
+  prof_init();
+  // Headless benchmark: no display needed, gtk_init is never called
+  for (int i = 1; i < argc; i++)
+    if (strcmp(argv[i], "--bench") == 0)
+      return run_bench_cli(argc, argv);
   gtk_init(&argc, &argv);
   AppData *app = g_new0(AppData, 1);
+  rng_seed(&app->rng, (uint64_t)g_get_real_time());
 
   // Init App
   app->is_dark_theme = TRUE; // Default
@@ -5341,12 +11439,30 @@ int main(int argc, char *argv[]) {
                                  "Shell Sort");
   gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(app->algo_selector_combo),
                                  "Quick Sort");
+  gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(app->algo_selector_combo),
+                                 "Intro Sort");
+  gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(app->algo_selector_combo),
+                                 "Radix Sort");
+  gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(app->algo_selector_combo),
+                                 "Parallel Sort");
+  gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(app->algo_selector_combo),
+                                 "Tim Sort");
   gtk_combo_box_set_active(GTK_COMBO_BOX(app->algo_selector_combo), 3);
   gtk_box_pack_start(GTK_BOX(hbox_settings), gtk_label_new("Algo:"), FALSE,
                      FALSE, 5);
   gtk_box_pack_start(GTK_BOX(hbox_settings), app->algo_selector_combo, FALSE,
                      FALSE, 0);
 
+  // Worker count for Parallel Sort, defaults to one per core
+  GtkWidget *threads_spin = gtk_spin_button_new_with_range(1, 256, 1);
+  gtk_spin_button_set_value(GTK_SPIN_BUTTON(threads_spin),
+                            resolve_sort_threads(0));
+  g_signal_connect(threads_spin, "value-changed",
+                   G_CALLBACK(on_threads_changed), app);
+  gtk_box_pack_start(GTK_BOX(hbox_settings), gtk_label_new("Threads:"), FALSE,
+                     FALSE, 5);
+  gtk_box_pack_start(GTK_BOX(hbox_settings), threads_spin, FALSE, FALSE, 0);
+
   GtkWidget *btn_compare = gtk_button_new_with_label("Comparer");
   g_signal_connect(btn_compare, "clicked", G_CALLBACK(on_compare_launch), app);
   gtk_box_pack_end(GTK_BOX(hbox_settings), btn_compare, FALSE, FALSE, 0);
@@ -5530,6 +11646,9 @@ int main(int argc, char *argv[]) {
   gtk_combo_box_set_active(GTK_COMBO_BOX(app->array_mode_combo), 0);
   gtk_box_pack_start(GTK_BOX(hbox_arr_config), app->array_mode_combo, FALSE,
                      FALSE, 0);
+  app->array_dist_combo = create_dist_combo();
+  gtk_box_pack_start(GTK_BOX(hbox_arr_config), app->array_dist_combo, FALSE,
+                     FALSE, 0);
 
   // Inputs
   app->array_size_entry = gtk_entry_new();
@@ -5605,12 +11724,19 @@ int main(int argc, char *argv[]) {
   gtk_combo_box_set_active(GTK_COMBO_BOX(app->list_mode_combo), 0);
   gtk_box_pack_start(GTK_BOX(hbox_list_gen), app->list_mode_combo, FALSE, FALSE,
                      0);
+  app->list_dist_combo = create_dist_combo();
+  gtk_box_pack_start(GTK_BOX(hbox_list_gen), app->list_dist_combo, FALSE, FALSE,
+                     0);
 
   app->list_type_combo = gtk_combo_box_text_new();
   gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(app->list_type_combo),
                                  "Simple");
   gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(app->list_type_combo),
                                  "Double");
+  gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(app->list_type_combo),
+                                 "D\xC3\xA9roul\xC3\xA9\x65");
+  gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(app->list_type_combo),
+                                 "\xC3\x80 enjambements");
   gtk_combo_box_set_active(GTK_COMBO_BOX(app->list_type_combo), 0);
   gtk_box_pack_start(GTK_BOX(hbox_list_gen), app->list_type_combo, FALSE, FALSE,
                      0);
@@ -5707,6 +11833,16 @@ int main(int argc, char *argv[]) {
   g_signal_connect(btn_sort_list, "clicked", G_CALLBACK(on_sort_list), app);
   gtk_box_pack_start(GTK_BOX(hbox_list_ops), btn_sort_list, FALSE, FALSE, 0);
 
+  // Relinks the nodes instead of sorting an array copy
+  GtkWidget *btn_merge_list = gtk_button_new_with_label("Tri fusion");
+  app->btn_list_merge = btn_merge_list;
+  gtk_widget_set_name(btn_merge_list, "btn_list_merge");
+  gtk_widget_set_tooltip_text(btn_merge_list,
+                              "Tri fusion en place : relie les n\xC5\x93uds "
+                              "sans copie dans un tableau");
+  g_signal_connect(btn_merge_list, "clicked", G_CALLBACK(on_sort_list), app);
+  gtk_box_pack_start(GTK_BOX(hbox_list_ops), btn_merge_list, FALSE, FALSE, 0);
+
   app->list_canvas = gtk_drawing_area_new();
   // Wrap in scrolled window
   GtkWidget *list_scroll = gtk_scrolled_window_new(NULL, NULL);
@@ -6030,5 +12166,10 @@ int main(int argc, char *argv[]) {
   gtk_widget_hide(g_object_get_data(G_OBJECT(app->window), "nav_box"));
 
   gtk_main();
+  // The benchmark thread must be done with its pools before exit frees them
+  if (app->bench_job) {
+    cancel_comparison_benchmark(app);
+    g_thread_join(app->bench_job->thread);
+  }
   return 0;
 }